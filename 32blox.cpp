@@ -103,6 +103,15 @@ void update( uint32_t p_time )
     else
     {
       m_menu_state->fini( nullptr );
+
+      /* The menu has been drawn all over the screen, too. */
+      if ( nullptr != m_handlers[m_state] )
+      {
+        m_handlers[m_state]->invalidate();
+      }
+
+      /* And the menu's images can go, unless the state is using them. */
+      AssetFactory::get_instance().evict();
     }
   }
 
@@ -137,6 +146,9 @@ void update( uint32_t p_time )
     /* Switch to the new state. */
     m_state = l_newstate;
 
+    /* Anything the old state used that the new one doesn't, can go. */
+    AssetFactory::get_instance().evict();
+
     /* Only call the update if we haven't been here before. */
     if ( m_current_tick != p_time )
     {
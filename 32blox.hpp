@@ -23,6 +23,12 @@
 #define SAVE_SLOT_HISCORE    0
 #define SAVE_SLOT_OUTPUT     1
 
+#define GAME_DATAFILE_DIR    ".gamedata/32blox"
+#define GAME_DATAFILE_REPLAY ".gamedata/32blox/last.rpl"
+#define GAME_DATAFILE_LEVELS ".gamedata/32blox/levels.pak"
+
+#define HASH_SEED            2166136261u
+
 
 /* Enums. */
 
@@ -36,6 +42,36 @@ typedef enum
   STATE_MAX
 } gamestate_t;
 
+typedef enum
+{
+  TARGET_32BLIT,
+  TARGET_PICOSYSTEM,
+  TARGET_SDL,
+  TARGET_MAX
+} target_type_t;
+
+
+/* Functions. */
+
+uint32_t hash_fnv1a( uint32_t, const void *, uint32_t );
+
+/* Count trailing zeros, for walking through the set bits of a mask; the */
+/* mask must not be zero. MSVC spells it differently to everyone else.   */
+#ifdef    _MSC_VER
+#include <intrin.h>
+inline uint8_t count_trailing_zeros( uint32_t p_mask )
+{
+  unsigned long l_index;
+  _BitScanForward( &l_index, p_mask );
+  return (uint8_t)l_index;
+}
+#else
+inline uint8_t count_trailing_zeros( uint32_t p_mask )
+{
+  return (uint8_t)__builtin_ctz( p_mask );
+}
+#endif /* _MSC_VER */
+
 
 /* Interfaces. */
 
@@ -46,6 +82,10 @@ public:
   virtual void        render( uint32_t ) = 0;
   virtual void        init( GameStateInterface * ) = 0;
   virtual void        fini( GameStateInterface * ) = 0;
+
+  /* Called when something else has drawn over the screen, so that states */
+  /* which only redraw what's changed know to start again from scratch.   */
+  virtual void        invalidate( void ) {}
 };
 
 
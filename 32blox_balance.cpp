@@ -0,0 +1,391 @@
+/*
+ * 32blox_balance.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * This is the entry point for the balancing runner; it plays thousands of
+ * independent games with the autopilot on the bat, spread across every core
+ * available, and reports how each level played out as CSV on stdout.
+ *
+ * Each game is seeded from its own index, so the results are the same no
+ * matter how many threads are used, or which thread ends up playing which
+ * game. Each worker owns its own simulation, and so its own RNG, and keeps
+ * its own tallies; the only thing shared is the work queues.
+ *
+ * Usage: 32blox_balance [games] [threads] [seed] [pico] [mega] [substeps=N]
+ */
+
+/* System headers. */
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+#include "GameSim.hpp"
+#include "Autopilot.hpp"
+
+
+/* Constants. */
+
+/* Games stop once they get this far; the levels wrap around after the last */
+/* one anyway, getting faster each time, so this covers a couple of laps.   */
+#define BALANCE_MAX_LEVEL   30
+
+/* And if the autopilot gets stuck in a loop it can't break out of, we give  */
+/* up on the level after this many ticks (five minutes of play).             */
+#define BALANCE_TICK_LIMIT  30000
+
+
+/* Structures. */
+
+typedef struct
+{
+  uint32_t    attempts;
+  uint32_t    clears;
+  uint32_t    stalls;
+  uint64_t    clear_ticks;
+  uint32_t    lives_lost;
+  uint32_t    drops[POWERUP_MAX];
+  uint32_t    collected[POWERUP_MAX];
+} level_stats_t;
+
+typedef struct
+{
+  level_stats_t levels[BALANCE_MAX_LEVEL + 1];
+  uint64_t      ticks;
+  uint32_t      games;
+} balance_stats_t;
+
+typedef struct
+{
+  std::mutex            lock;
+  std::deque<uint32_t>  games;
+} balance_queue_t;
+
+
+/* Module variables. */
+
+static const char *m_powerup_names[POWERUP_MAX] =
+{
+  "speed", "slow", "sticky", "shrink", "grow", "multi", "extra"
+};
+
+
+/* Functions. */
+
+/*
+ * play_game - plays a single game through to the end, tallying up as it goes.
+ *
+ * GameSim &         - the simulation to play it in
+ * uint32_t          - the seed for this game
+ * balance_stats_t * - the tallies to add the results to
+ */
+
+static void play_game( GameSim &p_sim, uint32_t p_seed, balance_stats_t *p_stats )
+{
+  uint16_t        l_level;
+  uint32_t        l_level_ticks = 0;
+  level_stats_t  *l_stats;
+
+  /* Start the game, and note that we're having a go at the first level. */
+  p_sim.reset( p_seed );
+  l_level = p_sim.get_level()->get_level();
+  l_stats = &p_stats->levels[l_level];
+  l_stats->attempts++;
+  p_stats->games++;
+
+  /* And then just play until something stops us. */
+  while( true )
+  {
+    p_sim.update( autopilot( p_sim ) );
+    p_sim.clear_collisions();
+    p_stats->ticks++;
+    l_level_ticks++;
+
+    /* Work through everything that happened this tick. */
+    for ( uint8_t l_index = 0; l_index < p_sim.get_event_count(); l_index++ )
+    {
+      const sim_event_t *l_event = p_sim.get_event( l_index );
+      switch( l_event->type )
+      {
+        case SIM_EVENT_POWERUP_DROPPED:
+          l_stats->drops[l_event->value]++;
+          break;
+        case SIM_EVENT_POWERUP_COLLECTED:
+          l_stats->collected[l_event->value]++;
+          break;
+        case SIM_EVENT_BALL_LOST:
+          l_stats->lives_lost++;
+          break;
+        case SIM_EVENT_LEVEL_COMPLETE:
+          l_stats->clears++;
+          l_stats->clear_ticks += l_level_ticks;
+
+          /* If that was the last level we care about, we're done. */
+          l_level = l_event->value;
+          if ( l_level > BALANCE_MAX_LEVEL )
+          {
+            return;
+          }
+
+          /* Otherwise, onto the next one. */
+          l_stats = &p_stats->levels[l_level];
+          l_stats->attempts++;
+          l_level_ticks = 0;
+          break;
+      }
+    }
+
+    /* Out of lives is the usual way out. */
+    if ( p_sim.get_lives() == 0 )
+    {
+      return;
+    }
+
+    /* But the autopilot can get itself stuck, so don't wait forever. */
+    if ( l_level_ticks > BALANCE_TICK_LIMIT )
+    {
+      l_stats->stalls++;
+      return;
+    }
+  }
+}
+
+
+/*
+ * next_game - finds the next game for a worker to play; it takes from the
+ *             front of its own queue first, and then steals from the back
+ *             of everyone else's once that runs dry.
+ *
+ * std::vector<balance_queue_t> & - all the work queues
+ * uint32_t                       - the index of the worker asking
+ * uint32_t *                     - where to put the game index
+ *
+ * Returns true if a game was found, false if there's nothing left to do.
+ */
+
+static bool next_game( std::vector<balance_queue_t> &p_queues, uint32_t p_worker, uint32_t *p_game )
+{
+  /* Try our own queue first. */
+  {
+    std::lock_guard<std::mutex> l_guard( p_queues[p_worker].lock );
+    if ( !p_queues[p_worker].games.empty() )
+    {
+      *p_game = p_queues[p_worker].games.front();
+      p_queues[p_worker].games.pop_front();
+      return true;
+    }
+  }
+
+  /* Then go looking at our neighbours. */
+  for ( uint32_t l_offset = 1; l_offset < p_queues.size(); l_offset++ )
+  {
+    balance_queue_t &l_victim = p_queues[( p_worker + l_offset ) % p_queues.size()];
+    std::lock_guard<std::mutex> l_guard( l_victim.lock );
+    if ( !l_victim.games.empty() )
+    {
+      *p_game = l_victim.games.back();
+      l_victim.games.pop_back();
+      return true;
+    }
+  }
+
+  /* Nothing left anywhere. */
+  return false;
+}
+
+
+/*
+ * write_csv - writes out the combined tallies, one row per level.
+ *
+ * FILE *                  - where to write the CSV
+ * const balance_stats_t * - the combined tallies
+ */
+
+static void write_csv( FILE *p_file, const balance_stats_t *p_stats )
+{
+  /* The header row first. */
+  fprintf( p_file, "level,attempts,clears,clear_rate,avg_ticks_to_clear,lives_lost,lives_lost_per_attempt,stalls" );
+  for ( uint8_t l_type = 0; l_type < POWERUP_MAX; l_type++ )
+  {
+    fprintf( p_file, ",drop_%s", m_powerup_names[l_type] );
+  }
+  for ( uint8_t l_type = 0; l_type < POWERUP_MAX; l_type++ )
+  {
+    fprintf( p_file, ",collect_%s", m_powerup_names[l_type] );
+  }
+  fprintf( p_file, "\n" );
+
+  /* And then a row for every level that anyone reached. */
+  for ( uint8_t l_level = 1; l_level <= BALANCE_MAX_LEVEL; l_level++ )
+  {
+    const level_stats_t *l_stats = &p_stats->levels[l_level];
+    if ( l_stats->attempts == 0 )
+    {
+      continue;
+    }
+
+    fprintf( p_file, "%u,%u,%u,%.4f,%.1f,%u,%.3f,%u",
+             l_level, l_stats->attempts, l_stats->clears,
+             (double)l_stats->clears / l_stats->attempts,
+             l_stats->clears ? (double)l_stats->clear_ticks / l_stats->clears : 0.0,
+             l_stats->lives_lost, (double)l_stats->lives_lost / l_stats->attempts,
+             l_stats->stalls );
+
+    /* Powerups are given per attempt, so levels can be compared directly. */
+    for ( uint8_t l_type = 0; l_type < POWERUP_MAX; l_type++ )
+    {
+      fprintf( p_file, ",%.3f", (double)l_stats->drops[l_type] / l_stats->attempts );
+    }
+    for ( uint8_t l_type = 0; l_type < POWERUP_MAX; l_type++ )
+    {
+      fprintf( p_file, ",%.3f", (double)l_stats->collected[l_type] / l_stats->attempts );
+    }
+    fprintf( p_file, "\n" );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * main - deals the games out between the workers, sets them going and then
+ *        gathers up the results.
+ */
+
+int main( int argc, char **argv )
+{
+  uint32_t      l_games = 10000;
+  uint32_t      l_threads = std::thread::hardware_concurrency();
+  uint32_t      l_seed = 1;
+  target_type_t l_target = TARGET_32BLIT;
+  bool          l_mega = false;
+  uint8_t       l_substeps = 1;
+
+  /* Pick up any arguments. */
+  if ( argc > 1 )
+  {
+    l_games = strtoul( argv[1], nullptr, 10 );
+  }
+  if ( argc > 2 )
+  {
+    l_threads = strtoul( argv[2], nullptr, 10 );
+  }
+  if ( argc > 3 )
+  {
+    l_seed = strtoul( argv[3], nullptr, 10 );
+  }
+  for ( int l_arg = 4; l_arg < argc; l_arg++ )
+  {
+    if ( strcmp( argv[l_arg], "pico" ) == 0 )
+    {
+      l_target = TARGET_PICOSYSTEM;
+    }
+    if ( strcmp( argv[l_arg], "mega" ) == 0 )
+    {
+      l_mega = true;
+    }
+    if ( strncmp( argv[l_arg], "substeps=", 9 ) == 0 )
+    {
+      l_substeps = strtoul( argv[l_arg] + 9, nullptr, 10 );
+    }
+  }
+  if ( l_threads == 0 )
+  {
+    l_threads = 1;
+  }
+
+  /* Deal the games out evenly; the stealing evens out the uneven lengths. */
+  std::vector<balance_queue_t> l_queues( l_threads );
+  for ( uint32_t l_game = 0; l_game < l_games; l_game++ )
+  {
+    l_queues[l_game % l_threads].games.push_back( l_game );
+  }
+
+  /* Every worker gets its own tallies, so they never have to share. */
+  std::vector<balance_stats_t> l_stats( l_threads );
+  memset( l_stats.data(), 0, sizeof( balance_stats_t ) * l_threads );
+
+  /* Now set them all going. */
+  auto l_start = std::chrono::steady_clock::now();
+  std::vector<std::thread> l_workers;
+  for ( uint32_t l_worker = 0; l_worker < l_threads; l_worker++ )
+  {
+    l_workers.emplace_back( [&, l_worker]()
+    {
+      uint32_t l_game;
+      GameSim  l_sim(
+        ( l_target == TARGET_PICOSYSTEM ) ? blit::Size( 240, 240 ) : blit::Size( 320, 240 ),
+        l_target
+      );
+      l_sim.set_mega_multiball( l_mega );
+      l_sim.set_substeps( l_substeps );
+
+      while( next_game( l_queues, l_worker, &l_game ) )
+      {
+        play_game( l_sim, l_seed + l_game, &l_stats[l_worker] );
+      }
+    } );
+  }
+
+  /* And wait for them all to finish. */
+  for ( auto &l_worker : l_workers )
+  {
+    l_worker.join();
+  }
+  auto l_end = std::chrono::steady_clock::now();
+
+  /* Gather up all the tallies into the first one. */
+  balance_stats_t *l_total = &l_stats[0];
+  for ( uint32_t l_worker = 1; l_worker < l_threads; l_worker++ )
+  {
+    const balance_stats_t *l_worker_stats = &l_stats[l_worker];
+    for ( uint8_t l_level = 0; l_level <= BALANCE_MAX_LEVEL; l_level++ )
+    {
+      level_stats_t       *l_into = &l_total->levels[l_level];
+      const level_stats_t *l_from = &l_worker_stats->levels[l_level];
+
+      l_into->attempts += l_from->attempts;
+      l_into->clears += l_from->clears;
+      l_into->stalls += l_from->stalls;
+      l_into->clear_ticks += l_from->clear_ticks;
+      l_into->lives_lost += l_from->lives_lost;
+      for ( uint8_t l_type = 0; l_type < POWERUP_MAX; l_type++ )
+      {
+        l_into->drops[l_type] += l_from->drops[l_type];
+        l_into->collected[l_type] += l_from->collected[l_type];
+      }
+    }
+    l_total->ticks += l_worker_stats->ticks;
+    l_total->games += l_worker_stats->games;
+  }
+
+  /* The CSV goes to stdout, the summary to stderr so it doesn't get in the way. */
+  write_csv( stdout, l_total );
+
+  double l_seconds = std::chrono::duration<double>( l_end - l_start ).count();
+  fprintf( stderr, "games:     %u\n", l_total->games );
+  fprintf( stderr, "threads:   %u\n", l_threads );
+  fprintf( stderr, "ticks:     %llu\n", (unsigned long long)l_total->ticks );
+  fprintf( stderr, "seconds:   %.3f\n", l_seconds );
+  fprintf( stderr, "ticks/sec: %.0f\n", l_total->ticks / l_seconds );
+
+  /* All done. */
+  return 0;
+}
+
+
+/* End of 32blox_balance.cpp */
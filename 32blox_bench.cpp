@@ -0,0 +1,516 @@
+/*
+ * 32blox_bench.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * This is the entry point for the microbenchmarks; it times the hot paths of
+ * the game simulation in isolation, counts any heap allocations they make,
+ * and writes the results out as JSON so that they can be compared between
+ * releases.
+ *
+ * Usage: 32blox_bench [output file] [milliseconds per benchmark]
+ */
+
+/* System headers. */
+
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+#include "GameSim.hpp"
+#include "Messages.hpp"
+
+
+/* Constants. */
+
+/* Operations are timed in batches, to keep the clock out of the results. */
+#define BENCH_BATCH         1000
+
+/* A full tick is much heavier, and the game needs resetting between runs. */
+#define BENCH_TICK_BATCH    100
+
+#define BENCH_MAX_RESULTS   32
+
+
+/* Structures. */
+
+typedef struct
+{
+  const char *name;
+  uint64_t    ops;
+  uint64_t    nanoseconds;
+  uint64_t    allocations;
+} bench_result_t;
+
+
+/* Module variables. */
+
+static uint64_t       m_allocations = 0;
+static uint64_t       m_target_nanoseconds = 250000000;
+static uint64_t       m_batch_allocations;
+static std::chrono::steady_clock::time_point m_batch_start;
+static bench_result_t m_results[BENCH_MAX_RESULTS];
+static uint8_t        m_result_count = 0;
+
+/* Results are folded into this, so the compiler can't throw the work away. */
+static volatile uint32_t m_sink;
+
+
+/* Functions. */
+
+/*
+ * operator new / delete - replaced, so that we can count every allocation
+ *                         made during a benchmark.
+ */
+
+void *operator new( size_t p_size )
+{
+  m_allocations++;
+  void *l_ptr = malloc( p_size ? p_size : 1 );
+  if ( l_ptr == nullptr )
+  {
+    throw std::bad_alloc();
+  }
+  return l_ptr;
+}
+void operator delete( void *p_ptr ) noexcept
+{
+  free( p_ptr );
+}
+void operator delete( void *p_ptr, size_t ) noexcept
+{
+  free( p_ptr );
+}
+
+
+/*
+ * bench_begin - starts a new benchmark result.
+ *
+ * const char * - the name of the benchmark
+ *
+ * Returns the result to accumulate timings into.
+ */
+
+static bench_result_t *bench_begin( const char *p_name )
+{
+  bench_result_t *l_result = &m_results[m_result_count++];
+
+  l_result->name = p_name;
+  l_result->ops = 0;
+  l_result->nanoseconds = 0;
+  l_result->allocations = 0;
+
+  return l_result;
+}
+
+
+/*
+ * bench_running - decides if a benchmark has run for long enough yet.
+ *
+ * bench_result_t * - the result so far
+ */
+
+static bool bench_running( bench_result_t *p_result )
+{
+  return p_result->nanoseconds < m_target_nanoseconds;
+}
+
+
+/*
+ * bench_start / bench_stop - bracket a timed batch of operations; anything
+ *                            done outside of them (setup, mostly) is free.
+ */
+
+static void bench_start( void )
+{
+  m_batch_allocations = m_allocations;
+  m_batch_start = std::chrono::steady_clock::now();
+}
+static void bench_stop( bench_result_t *p_result, uint64_t p_ops )
+{
+  auto l_end = std::chrono::steady_clock::now();
+
+  p_result->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>( l_end - m_batch_start ).count();
+  p_result->allocations += m_allocations - m_batch_allocations;
+  p_result->ops += p_ops;
+}
+
+
+/*
+ * bench_ball_* - the ball physics; moving, and bouncing off things.
+ */
+
+static void bench_ball_update( void )
+{
+  bench_result_t *l_result = bench_begin( "ball_update" );
+  Ball            l_ball( blit::Point( 160, 120 ), 320 );
+
+  l_ball.randomise( 1 );
+  while( bench_running( l_result ) )
+  {
+    bench_start();
+    for ( uint32_t l_index = 0; l_index < BENCH_BATCH; l_index++ )
+    {
+      l_ball.update();
+    }
+    bench_stop( l_result, BENCH_BATCH );
+  }
+
+  m_sink = m_sink + l_ball.get_bounds().x;
+}
+
+static void bench_ball_bounce( void )
+{
+  bench_result_t *l_result = bench_begin( "ball_bounce" );
+  Ball            l_ball( blit::Point( 160, 120 ), 320 );
+
+  l_ball.randomise( 1 );
+  while( bench_running( l_result ) )
+  {
+    bench_start();
+    for ( uint32_t l_index = 0; l_index < BENCH_BATCH; l_index++ )
+    {
+      l_ball.bounce( l_index & 1 );
+    }
+    bench_stop( l_result, BENCH_BATCH );
+  }
+
+  m_sink = m_sink + l_ball.moving_up();
+}
+
+static void bench_ball_bat_bounce( void )
+{
+  bench_result_t *l_result = bench_begin( "ball_bat_bounce" );
+  blit::Rect      l_bat( 148, 230, 24, 4 );
+
+  while( bench_running( l_result ) )
+  {
+    /* Set up a ball that's just landed on the bat. */
+    Ball l_ball( blit::Point( 156, 227 ), 320 );
+    l_ball.move_bat( l_bat, 0.0f, false );
+    l_ball.randomise( l_result->ops );
+    l_ball.bounce( false );
+
+    /* And then bounce it; every other bounce sends it back down again. */
+    bench_start();
+    for ( uint32_t l_index = 0; l_index < BENCH_BATCH; l_index++ )
+    {
+      if ( !l_ball.bat_bounce( l_bat.y, false ) )
+      {
+        l_ball.bounce( false );
+      }
+    }
+    bench_stop( l_result, BENCH_BATCH );
+
+    m_sink = m_sink + l_ball.moving_left();
+  }
+}
+
+
+/*
+ * bench_screen_to_brick - translating screen locations into the brick grid.
+ */
+
+static void bench_screen_to_brick( void )
+{
+  bench_result_t *l_result = bench_begin( "screen_to_brick" );
+  GameSim         l_sim( blit::Size( 320, 240 ), TARGET_32BLIT );
+  uint32_t        l_total = 0;
+
+  l_sim.reset( 1 );
+  while( bench_running( l_result ) )
+  {
+    bench_start();
+    for ( uint32_t l_index = 0; l_index < BENCH_BATCH; l_index++ )
+    {
+      blit::Point l_brick = l_sim.screen_to_brick( blit::Point( l_index % 320, ( l_index * 7 ) % 240 ) );
+      l_total += l_brick.x + l_brick.y;
+    }
+    bench_stop( l_result, BENCH_BATCH );
+  }
+
+  m_sink = m_sink + l_total;
+}
+
+
+/*
+ * bench_level_* - querying and knocking out the bricks in a level.
+ */
+
+static void bench_level_get_brick_count( void )
+{
+  bench_result_t *l_result = bench_begin( "level_get_brick_count" );
+  Level           l_level( 1, TARGET_32BLIT );
+  uint32_t        l_total = 0;
+
+  while( bench_running( l_result ) )
+  {
+    bench_start();
+    for ( uint32_t l_index = 0; l_index < BENCH_BATCH; l_index++ )
+    {
+      l_total += l_level.get_brick_count();
+    }
+    bench_stop( l_result, BENCH_BATCH );
+  }
+
+  m_sink = m_sink + l_total;
+}
+
+static void bench_level_hit_brick( void )
+{
+  bench_result_t *l_result = bench_begin( "level_hit_brick" );
+  Level           l_level;
+  uint32_t        l_total = 0;
+
+  while( bench_running( l_result ) )
+  {
+    /* Every pass needs a fresh set of bricks to hit. */
+    l_level.reset( 1, TARGET_32BLIT );
+    uint32_t l_ops = 0;
+
+    /* Hit every cell a few times, to work through the multi-hit bricks. */
+    bench_start();
+    for ( uint8_t l_pass = 0; l_pass < 4; l_pass++ )
+    {
+      for ( uint8_t l_row = 0; l_row < l_level.get_height(); l_row++ )
+      {
+        for ( uint8_t l_column = 0; l_column < l_level.get_width(); l_column++ )
+        {
+          l_total += l_level.hit_brick( blit::Point( l_column, l_row ) );
+          l_ops++;
+        }
+      }
+    }
+    bench_stop( l_result, l_ops );
+  }
+
+  m_sink = m_sink + l_total;
+}
+
+
+/*
+ * bench_level_reset - reloading a level in place, as happens between levels.
+ */
+
+static void bench_level_reset( void )
+{
+  bench_result_t *l_result = bench_begin( "level_reset" );
+  Level           l_level;
+  uint32_t        l_total = 0;
+
+  while( bench_running( l_result ) )
+  {
+    bench_start();
+    for ( uint32_t l_index = 0; l_index < BENCH_BATCH; l_index++ )
+    {
+      l_level.reset( l_index % Level::get_level_count( TARGET_32BLIT ) + 1, TARGET_32BLIT );
+      l_total += l_level.get_brick_count();
+    }
+    bench_stop( l_result, BENCH_BATCH );
+  }
+
+  m_sink = m_sink + l_total;
+}
+
+
+/*
+ * bench_get_text - looking up the text for a message.
+ */
+
+static void bench_get_text( void )
+{
+  bench_result_t *l_result = bench_begin( "get_text" );
+  uint32_t        l_total = 0;
+
+  while( bench_running( l_result ) )
+  {
+    bench_start();
+    for ( uint32_t l_index = 0; l_index < BENCH_BATCH; l_index++ )
+    {
+      str_message_t l_message = (str_message_t)( l_index % ( STR_MENU_URL + 1 ) );
+      l_total += get_message( LANG_EN, TARGET_32BLIT, l_message )[0];
+    }
+    bench_stop( l_result, BENCH_BATCH );
+  }
+
+  m_sink = m_sink + l_total;
+}
+
+
+/*
+ * bench_update - a full tick of the game simulation, with the given number of
+ *                balls in play.
+ *
+ * const char * - the name of the benchmark
+ * uint8_t      - the number of balls to have in play
+ * uint8_t      - the number of physics substeps per tick
+ */
+
+static void bench_update( const char *p_name, uint8_t p_balls, uint8_t p_substeps = 1 )
+{
+  bench_result_t *l_result = bench_begin( p_name );
+  GameSim         l_sim( blit::Size( 320, 240 ), TARGET_32BLIT );
+  sim_input_t     l_launch = { SIM_INPUT_LAUNCH, 0 };
+  sim_input_t     l_idle = { 0, 0 };
+  uint32_t        l_seed = 1;
+
+  l_sim.set_substeps( p_substeps );
+  while( bench_running( l_result ) )
+  {
+    /* Start a fresh game, with all the balls in flight. */
+    l_sim.reset( l_seed++ );
+    l_sim.add_balls( p_balls - 1 );
+    l_sim.update( l_launch );
+
+    /* And let it run for a little while. */
+    bench_start();
+    for ( uint32_t l_index = 0; l_index < BENCH_TICK_BATCH; l_index++ )
+    {
+      l_sim.update( l_idle );
+      l_sim.clear_collisions();
+    }
+    bench_stop( l_result, BENCH_TICK_BATCH );
+
+    m_sink = m_sink + l_sim.get_score();
+  }
+}
+
+
+/*
+ * bench_update_swarm - a full tick of the game simulation, with a mega
+ *                      multiball swarm of the given size let loose.
+ *
+ * const char * - the name of the benchmark
+ * uint16_t     - the number of swarm balls to have in play
+ */
+
+static void bench_update_swarm( const char *p_name, uint16_t p_balls )
+{
+  bench_result_t *l_result = bench_begin( p_name );
+  GameSim         l_sim( blit::Size( 320, 240 ), TARGET_32BLIT );
+  sim_input_t     l_launch = { SIM_INPUT_LAUNCH, 0 };
+  sim_input_t     l_idle = { 0, 0 };
+  uint32_t        l_seed = 1;
+
+  l_sim.set_mega_multiball( true );
+  while( bench_running( l_result ) )
+  {
+    /* Start a fresh game, with the whole swarm in flight. */
+    l_sim.reset( l_seed++ );
+    l_sim.add_swarm( p_balls );
+    l_sim.update( l_launch );
+
+    /* And let it run for a little while. */
+    bench_start();
+    for ( uint32_t l_index = 0; l_index < BENCH_TICK_BATCH; l_index++ )
+    {
+      l_sim.update( l_idle );
+      l_sim.clear_collisions();
+    }
+    bench_stop( l_result, BENCH_TICK_BATCH );
+
+    m_sink = m_sink + l_sim.get_score();
+  }
+}
+
+
+/*
+ * write_json - writes all the results out to a file, for later comparison.
+ *
+ * const char * - the name of the file to write
+ *
+ * Returns true if the file was written, false if not.
+ */
+
+static bool write_json( const char *p_filename )
+{
+  FILE *l_file = fopen( p_filename, "w" );
+  if ( l_file == nullptr )
+  {
+    return false;
+  }
+
+  fprintf( l_file, "{\n  \"benchmarks\": [\n" );
+  for ( uint8_t l_index = 0; l_index < m_result_count; l_index++ )
+  {
+    const bench_result_t *l_result = &m_results[l_index];
+    fprintf( l_file, "    { \"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.3f, \"allocs_per_op\": %.4f }%s\n",
+             l_result->name, (unsigned long long)l_result->ops,
+             (double)l_result->nanoseconds / l_result->ops,
+             (double)l_result->allocations / l_result->ops,
+             ( l_index + 1 < m_result_count ) ? "," : "" );
+  }
+  fprintf( l_file, "  ]\n}\n" );
+
+  fclose( l_file );
+  return true;
+}
+
+
+/*
+ * main - runs every benchmark in turn, and reports on them.
+ */
+
+int main( int argc, char **argv )
+{
+  const char *l_filename = "32blox_bench.json";
+
+  /* Pick up any arguments. */
+  if ( argc > 1 )
+  {
+    l_filename = argv[1];
+  }
+  if ( argc > 2 )
+  {
+    m_target_nanoseconds = strtoull( argv[2], nullptr, 10 ) * 1000000;
+  }
+
+  /* Run all the benchmarks. */
+  bench_ball_update();
+  bench_ball_bounce();
+  bench_ball_bat_bounce();
+  bench_screen_to_brick();
+  bench_level_get_brick_count();
+  bench_level_hit_brick();
+  bench_level_reset();
+  bench_get_text();
+  bench_update( "update_1_ball", 1 );
+  bench_update( "update_3_balls", 3 );
+  bench_update( "update_64_balls", 64 );
+  bench_update( "update_3_balls_2_steps", 3, 2 );
+  bench_update( "update_3_balls_4_steps", 3, 4 );
+  bench_update_swarm( "update_swarm_64", 64 );
+  bench_update_swarm( "update_swarm_512", 512 );
+
+  /* Report on them to the user. */
+  printf( "%-24s %14s %12s %14s\n", "benchmark", "ops", "ns/op", "allocs/op" );
+  for ( uint8_t l_index = 0; l_index < m_result_count; l_index++ )
+  {
+    const bench_result_t *l_result = &m_results[l_index];
+    printf( "%-24s %14llu %12.2f %14.4f\n",
+            l_result->name, (unsigned long long)l_result->ops,
+            (double)l_result->nanoseconds / l_result->ops,
+            (double)l_result->allocations / l_result->ops );
+  }
+
+  /* And save them somewhere more permanent. */
+  if ( !write_json( l_filename ) )
+  {
+    fprintf( stderr, "unable to write %s\n", l_filename );
+    return 1;
+  }
+
+  /* All done. */
+  return 0;
+}
+
+
+/* End of 32blox_bench.cpp */
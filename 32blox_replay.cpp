@@ -0,0 +1,122 @@
+/*
+ * 32blox_replay.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * This is the entry point for the headless replayer; it feeds a recorded game
+ * back through the simulation as fast as it'll go, with no rendering, and
+ * checks the state hash on every tick to report exactly where (if anywhere)
+ * the replay diverges from the original.
+ *
+ * Usage: 32blox_replay <replay file>
+ */
+
+/* System headers. */
+
+#include <chrono>
+#include <stdio.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+#include "GameSim.hpp"
+#include "Replay.hpp"
+
+
+/* Functions. */
+
+/*
+ * main - replays the file given, tick by tick.
+ */
+
+int main( int argc, char **argv )
+{
+  FILE           *l_file;
+  uint8_t         l_buffer[REPLAY_HEADER_SIZE];
+  replay_header_t l_header;
+  sim_input_t     l_input;
+  uint16_t        l_expected;
+  uint64_t        l_tick = 0;
+
+  /* Sanity check our arguments. */
+  if ( argc < 2 )
+  {
+    fprintf( stderr, "usage: %s <replay file>\n", argv[0] );
+    return 2;
+  }
+
+  /* Open the replay, and make sure it is one. */
+  l_file = fopen( argv[1], "rb" );
+  if ( l_file == nullptr )
+  {
+    fprintf( stderr, "unable to open %s\n", argv[1] );
+    return 2;
+  }
+  if ( fread( l_buffer, REPLAY_HEADER_SIZE, 1, l_file ) != 1 || !replay_read_header( &l_header, l_buffer ) )
+  {
+    fprintf( stderr, "%s is not a valid replay file\n", argv[1] );
+    fclose( l_file );
+    return 2;
+  }
+
+  /* The sums have to be done the same way, or nothing will match. */
+  if ( ( l_header.flags & REPLAY_BUILD_MASK ) != REPLAY_BUILD_FLAGS )
+  {
+    fprintf( stderr, "%s was recorded with %s physics, this build uses %s\n", argv[1],
+             ( l_header.flags & REPLAY_FLAG_FIXED ) ? "fixed point" : "floating point",
+             ( REPLAY_BUILD_FLAGS & REPLAY_FLAG_FIXED ) ? "fixed point" : "floating point" );
+    fclose( l_file );
+    return 2;
+  }
+
+  /* And the levels have to be the ones it was played on. */
+  if ( l_header.flags & REPLAY_FLAG_PACK )
+  {
+    fprintf( stderr, "%s was played on a level pack, which can't be replayed here\n", argv[1] );
+    fclose( l_file );
+    return 2;
+  }
+
+  /* Set up the simulation exactly as it was when recorded. */
+  GameSim l_sim( blit::Size( l_header.width, l_header.height ), l_header.target );
+  l_sim.set_mega_multiball( l_header.flags & REPLAY_FLAG_MEGA );
+  l_sim.set_substeps( l_header.substeps );
+  l_sim.reset( l_header.seed );
+
+  /* And then feed it every tick, checking the hash as we go. */
+  auto l_start = std::chrono::steady_clock::now();
+  while ( fread( l_buffer, REPLAY_TICK_SIZE, 1, l_file ) == 1 )
+  {
+    replay_read_tick( &l_input, &l_expected, l_buffer );
+    l_sim.update( l_input );
+    l_sim.clear_collisions();
+
+    uint16_t l_actual = replay_fold_hash( l_sim.get_hash() );
+    if ( l_actual != l_expected )
+    {
+      printf( "diverged at tick %llu: expected %04x, got %04x\n",
+              (unsigned long long)l_tick, l_expected, l_actual );
+      fclose( l_file );
+      return 1;
+    }
+    l_tick++;
+  }
+  auto l_end = std::chrono::steady_clock::now();
+  fclose( l_file );
+
+  /* If we got here, everything matched. */
+  double l_seconds = std::chrono::duration<double>( l_end - l_start ).count();
+  printf( "replayed %llu ticks cleanly in %.3fs (level %u, score %u, lives %u)\n",
+          (unsigned long long)l_tick, l_seconds,
+          l_sim.get_level()->get_level(), l_sim.get_score(), l_sim.get_lives() );
+
+  /* All done. */
+  return 0;
+}
+
+
+/* End of 32blox_replay.cpp */
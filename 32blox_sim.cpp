@@ -0,0 +1,119 @@
+/*
+ * 32blox_sim.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * This is the entry point for the headless soak tester; it runs the game
+ * simulation flat out with a simple autopilot on the bat, with no screen or
+ * blit runtime involved, and reports how it got on.
+ *
+ * Usage: 32blox_sim [ticks] [seed] [pico] [mega] [substeps=N]
+ */
+
+/* System headers. */
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+#include "GameSim.hpp"
+#include "Autopilot.hpp"
+
+
+/* Functions. */
+
+/*
+ * main - runs the requested number of ticks, starting a new game whenever the
+ *        autopilot runs out of lives.
+ */
+
+int main( int argc, char **argv )
+{
+  uint64_t      l_ticks = 10000000;
+  uint32_t      l_seed = 1;
+  target_type_t l_target = TARGET_32BLIT;
+  uint32_t      l_games = 1;
+  uint16_t      l_max_level = 1;
+  uint64_t      l_total_score = 0;
+  bool          l_mega = false;
+  uint8_t       l_substeps = 1;
+
+  /* Pick up any arguments. */
+  if ( argc > 1 )
+  {
+    l_ticks = strtoull( argv[1], nullptr, 10 );
+  }
+  if ( argc > 2 )
+  {
+    l_seed = strtoul( argv[2], nullptr, 10 );
+  }
+  for ( int l_arg = 3; l_arg < argc; l_arg++ )
+  {
+    if ( strcmp( argv[l_arg], "pico" ) == 0 )
+    {
+      l_target = TARGET_PICOSYSTEM;
+    }
+    if ( strcmp( argv[l_arg], "mega" ) == 0 )
+    {
+      l_mega = true;
+    }
+    if ( strncmp( argv[l_arg], "substeps=", 9 ) == 0 )
+    {
+      l_substeps = strtoul( argv[l_arg] + 9, nullptr, 10 );
+    }
+  }
+
+  /* The playing field is the size of the target's screen. */
+  GameSim l_sim(
+    ( l_target == TARGET_PICOSYSTEM ) ? blit::Size( 240, 240 ) : blit::Size( 320, 240 ),
+    l_target
+  );
+  l_sim.set_mega_multiball( l_mega );
+  l_sim.set_substeps( l_substeps );
+  l_sim.reset( l_seed );
+
+  /* And then just run, flat out. */
+  auto l_start = std::chrono::steady_clock::now();
+  for ( uint64_t l_tick = 0; l_tick < l_ticks; l_tick++ )
+  {
+    l_sim.update( autopilot( l_sim ) );
+    l_sim.clear_collisions();
+
+    /* Keep track of how far we got. */
+    if ( l_sim.get_level()->get_level() > l_max_level )
+    {
+      l_max_level = l_sim.get_level()->get_level();
+    }
+
+    /* Out of lives means a fresh game, with a fresh seed. */
+    if ( l_sim.get_lives() == 0 )
+    {
+      l_total_score += l_sim.get_score();
+      l_sim.reset( l_seed + l_games++ );
+    }
+  }
+  auto l_end = std::chrono::steady_clock::now();
+
+  /* Report back on how it all went. */
+  double l_seconds = std::chrono::duration<double>( l_end - l_start ).count();
+  printf( "ticks:       %llu\n", (unsigned long long)l_ticks );
+  printf( "seconds:     %.3f\n", l_seconds );
+  printf( "ticks/sec:   %.0f\n", l_ticks / l_seconds );
+  printf( "games:       %u\n", l_games );
+  printf( "max level:   %u\n", l_max_level );
+  printf( "total score: %llu\n", (unsigned long long)( l_total_score + l_sim.get_score() ) );
+
+  /* All done. */
+  return 0;
+}
+
+
+/* End of 32blox_sim.cpp */
@@ -7,6 +7,10 @@
  *
  * The AssetFactory is a singleton class to hold inflated assets, so that we
  * don't end up wasting memory on multiple copies of things like sprite sheets.
+ *
+ * Images are unpacked on first use, and reference counted by the states that
+ * use them; they're evicted between states, rather than the moment the last
+ * reference goes, so that the next state can pick up anything it shares.
  */
 
 /* System headers. */
@@ -20,23 +24,43 @@
 #include "32blox.hpp"
 
 #include "AssetFactory.hpp"
-#include "assets_images.hpp"
+#include "assets_packed.hpp"
+
+
+/* Module variables. */
+
+static const uint8_t *m_image_data[ASSET_MAX] =
+{
+  a_pack_logo,
+  a_pack_long_logo,
+  a_pack_game_sprites
+};
+
+/* The logos are drawn whole, so they may as well be kept unpacked whole; */
+/* only a few rows of the spritesheet are ever used, though.              */
+static const uint16_t m_image_bands[ASSET_MAX] =
+{
+  0,
+  0,
+  PACKED_SPRITE_BANDS
+};
 
 
 /* Functions. */
 
 /*
- * constructor - Initialises all the asset objects
+ * constructor - Initialises all the asset objects; the images themselves
+ *               aren't loaded until they're needed.
  */
 
 AssetFactory::AssetFactory( void )
 {
-  /* Load up the primary sprite sheet. */
-  spritesheet_game = blit::Surface::load( a_img_game_sprites );
-
-  /* And then any individual image assets. */
-  surface_logo = blit::Surface::load( a_img_logo );
-  surface_long_logo = blit::Surface::load( a_img_long_logo );
+  /* Nothing is loaded, and nobody wants anything yet. */
+  for ( uint8_t l_index = 0; l_index < ASSET_MAX; l_index++ )
+  {
+    images[l_index] = nullptr;
+    references[l_index] = 0;
+  }
 
   /* Determine what our hardware target is. */
 #ifdef TARGET_32BLIT_HW
@@ -69,126 +93,84 @@ AssetFactory &AssetFactory::get_instance( void )
 
 
 /*
- * get_text - fetches the correct text to use for a given message, based both
- *            on the current language and whether we're on a physical Blit,
- *            or emulated on a desktop.
+ * acquire - fetches an image, setting it up if it isn't already; every call
+ *           to this should be matched by a call to release, once it's done with.
+ *
+ * asset_t - the image required
+ *
+ * Returns the packed image, which unpacks itself as it's drawn.
  */
 
-const char *AssetFactory::get_text( str_message_t p_message )
+PackedImage *AssetFactory::acquire( asset_t p_asset )
+{
+  /* Sanity check the asset. */
+  if ( p_asset >= ASSET_MAX )
+  {
+    return nullptr;
+  }
+
+  /* Set it up if we have to, and count the new reference. */
+  if ( images[p_asset] == nullptr )
+  {
+    images[p_asset] = new PackedImage( m_image_data[p_asset], m_image_bands[p_asset] );
+  }
+  references[p_asset]++;
+
+  return images[p_asset];
+}
+
+
+/*
+ * release - lets go of an image; it stays loaded until the next evict, in
+ *           case whatever comes next wants it too.
+ *
+ * asset_t - the image no longer required
+ */
+
+void AssetFactory::release( asset_t p_asset )
 {
-  const char *l_text = "undefined";
+  /* Sanity check the asset. */
+  if ( p_asset >= ASSET_MAX || references[p_asset] == 0 )
+  {
+    return;
+  }
+
+  references[p_asset]--;
+
+  /* All done. */
+  return;
+}
 
-  /* Choose between languages, and then messages. */
-  switch( c_language )
+
+/*
+ * evict - frees up any images which nobody is using any more.
+ */
+
+void AssetFactory::evict( void )
+{
+  for ( uint8_t l_index = 0; l_index < ASSET_MAX; l_index++ )
   {
-    case LANG_EN:        /* English */
-      switch( p_message )
-      {
-        case STR_A_TO_START:
-          if ( TARGET_32BLIT == c_target )
-            l_text = "PRESS 'A' TO START";
-          else if ( TARGET_PICOSYSTEM == c_target )
-            l_text = "'A' TO START";
-          else
-            l_text = "PRESS 'Z' TO START";
-          break;
-        case STR_B_TO_LAUNCH:
-          if ( TARGET_32BLIT == c_target )
-            l_text = "PRESS 'B' TO LAUNCH";
-          else if ( TARGET_PICOSYSTEM == c_target )
-            l_text = "'B' TO LAUNCH";
-          else
-            l_text = "PRESS 'X' TO LAUNCH";
-          break;
-        case STR_B_TO_SAVE:
-          if ( TARGET_32BLIT == c_target )
-            l_text = "PRESS 'B' TO SAVE";
-          else if ( TARGET_PICOSYSTEM == c_target )
-            l_text = "'B' TO SAVE";
-          else
-            l_text = "PRESS 'X' TO SAVE";
-          break;
-        case STR_MENU_TO_EXIT:
-          if ( TARGET_32BLIT == c_target )
-            l_text = "PRESS <MENU> TO EXIT";
-          else
-            l_text = "PRESS '2' TO EXIT";
-          break;
-
-        case STR_LANG_EN:
-          l_text = "English";
-          break;
-        case STR_NEW_HIGH_SCORE:
-          l_text = "NEW HIGH SCORE!";
-          break;
-        case STR_LEFT_RIGHT_SELECT:
-          l_text = "LEFT/RIGHT TO SELECT";
-          break;
-        case STR_UP_DOWN_CHANGE:
-          l_text = "UP/DOWN TO CHANGE";
-          break;
-        case STR_LEVEL:
-          l_text = "LEVEL";
-          break;
-        case STR_POWERUP_SPEED:
-          l_text = "SPEED\nUP!";
-          break;
-        case STR_POWERUP_SLOW:
-          l_text = "SLOW\nDOWN";
-          break;
-        case STR_POWERUP_STICKY:
-          l_text = "STICKY\nBAT!";
-          break;
-        case STR_POWERUP_GROW:
-          l_text = "GROW\nBAT!";
-          break;
-        case STR_POWERUP_SHRINK:
-          l_text = "SHRINK\nBAT!";
-          break;
-        case STR_POWERUP_MULTI:
-          l_text = "MULTI\nBALL";
-          break;
-        case STR_POWERUP_EXTRA:
-          l_text = "EXTRA\nLIFE";
-          break;
-        case STR_GAME_OVER:
-          l_text = "GAME\nOVER";
-          break;
-        case STR_BALL_LOST:
-          l_text = "BALL\nLOST";
-          break;
-        case STR_SCORE:
-          l_text = "SCORE";
-          break;
-        case STR_HISCORE:
-          l_text = "HI";
-          break;
-        case STR_HIGH_SCORES:
-          l_text = "HIGH SCORES";
-          break;
-        case STR_MENU_SOUND:
-          l_text = "Sound";
-          break;
-        case STR_MENU_MUSIC:
-          l_text = "Music";
-          break;
-        case STR_MENU_HAPTIC:
-          l_text = "Haptic";
-          break;
-        case STR_MENU_ON:
-          l_text = "  <ON>";
-          break;
-        case STR_MENU_OFF:
-          l_text = " <OFF>";
-          break;
-        case STR_MENU_URL:
-        l_text = "VISIT US AT https://blithub.co.uk";
-          break;
-      }
+    if ( images[l_index] != nullptr && references[l_index] == 0 )
+    {
+      delete images[l_index];
+      images[l_index] = nullptr;
+    }
   }
 
-  /* Return the match. */
-  return l_text;
+  /* All done. */
+  return;
+}
+
+
+/*
+ * get_text - fetches the correct text to use for a given message, based both
+ *            on the current language and whether we're on a physical Blit,
+ *            or emulated on a desktop.
+ */
+
+const char *AssetFactory::get_text( str_message_t p_message )
+{
+  return get_message( c_language, c_target, p_message );
 }
 
 
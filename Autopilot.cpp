@@ -0,0 +1,429 @@
+/*
+ * Autopilot.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The autopilot is a scripted bat controller, for driving the game simulation
+ * without a player; it's used by the headless tools. It predicts where each
+ * ball will come down, and aims it back at the bricks, so that it clears
+ * levels reliably enough for the balancing figures to mean something.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+#include "Autopilot.hpp"
+
+
+/* Constants. */
+
+/* The predicted path is walked this far down the screen at a time, and for  */
+/* no more than this many steps; far enough for a couple of trips up and down. */
+#define AUTOPILOT_STRIDE    2
+#define AUTOPILOT_STEPS     512
+
+/* And the bat only bothers to aim once the ball is this close to it. */
+#define AUTOPILOT_AIM_RANGE 64
+
+
+/* Structures. */
+
+/* What the autopilot needs to know about the playing field; taken once per */
+/* tick, as the path of every ball gets walked through it.                  */
+typedef struct
+{
+  int32_t     margin;
+  int32_t     width;
+  int32_t     rows;
+  int32_t     columns;
+  int32_t     bat_height;
+  int32_t     bottom;
+  uint16_t    row_mask[MAX_BOARD_HEIGHT];
+} autopilot_field_t;
+
+
+/* Functions. */
+
+/*
+ * read_field - takes a snapshot of the playing field, for the next tick.
+ *
+ * GameSim &           - the simulation being driven
+ * autopilot_field_t * - the field to fill in
+ */
+
+static void read_field( GameSim &p_sim, autopilot_field_t *p_field )
+{
+  Level *l_level = p_sim.get_level();
+
+  p_field->margin = l_level->get_margin();
+  p_field->width = p_sim.get_bounds().w;
+  p_field->rows = l_level->get_height();
+  p_field->columns = l_level->get_width();
+  p_field->bat_height = p_sim.get_bat_height();
+
+  /* The bottom is below the lowest row that still has any bricks in it. */
+  p_field->bottom = BRICK_TOP;
+  for ( int32_t l_row = 0; l_row < p_field->rows; l_row++ )
+  {
+    p_field->row_mask[l_row] = l_level->get_row_mask( l_row );
+    if ( p_field->row_mask[l_row] != 0 )
+    {
+      p_field->bottom = BRICK_TOP + ( l_row + 1 ) * BRICK_HEIGHT;
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * brick_at - checks if there's a brick (of any sort) at a point on the screen.
+ *
+ * autopilot_field_t & - the playing field
+ * int32_t             - the x and y of the point to check
+ */
+
+static bool brick_at( const autopilot_field_t &p_field, int32_t p_x, int32_t p_y )
+{
+  int32_t l_x = p_x - p_field.margin;
+  int32_t l_y = p_y - BRICK_TOP;
+
+  if ( l_x < 0 || l_y < 0 || l_y >= p_field.bottom - BRICK_TOP )
+  {
+    return false;
+  }
+
+  int32_t l_column = l_x / BRICK_WIDTH;
+  if ( l_column >= p_field.columns )
+  {
+    return false;
+  }
+  return ( p_field.row_mask[l_y / BRICK_HEIGHT] & ( 1u << l_column ) ) != 0;
+}
+
+
+/*
+ * predict_landing - works out where a ball will cross the bat row, walking
+ *                   its path a stride at a time and bouncing it off the walls,
+ *                   the top and any bricks in the way (as if they'd survive
+ *                   the hit). Returns how far it has to travel up and down
+ *                   the screen to get there.
+ *
+ * autopilot_field_t & - the playing field
+ * sim_vec_t           - the location of the centre of the ball
+ * sim_vec_t           - the movement of the ball each update
+ * sim_num_t           - the distance from the centre of the ball to its edges
+ * int32_t *           - where to store the predicted x of the centre of the ball
+ * sim_vec_t *         - where to store the direction it'll be heading in by then
+ */
+
+static sim_num_t predict_landing( const autopilot_field_t &p_field, sim_vec_t p_location, sim_vec_t p_vector,
+                                  sim_num_t p_extent, int32_t *p_landing, sim_vec_t *p_heading )
+{
+  sim_num_t l_floor = sim_num_t( p_field.bat_height ) - p_extent;
+  sim_num_t l_left = sim_num_t( p_field.margin ) + p_extent;
+  sim_num_t l_right = sim_num_t( p_field.width - p_field.margin ) - p_extent;
+  sim_num_t l_bottom = sim_num_t( p_field.bottom ) + p_extent;
+  sim_num_t l_rise = sim_abs( p_vector.y );
+
+  /* Something not moving up or down can't be predicted; just stay put. */
+  *p_landing = sim_to_int( p_location.x );
+  *p_heading = p_vector;
+  if ( l_rise == sim_num_t( 0 ) )
+  {
+    return sim_num_t( 0 );
+  }
+
+  /* Scale the movement up to a whole stride down (or up) the screen. */
+  sim_vec_t l_step = p_vector * ( sim_num_t( AUTOPILOT_STRIDE ) / l_rise );
+  sim_vec_t l_location = p_location;
+  uint16_t  l_steps = 0;
+
+  while ( l_steps < AUTOPILOT_STEPS )
+  {
+    /* Once it's heading down past the bat, we know where it'll be. */
+    if ( l_step.y > sim_num_t( 0 ) && l_location.y >= l_floor )
+    {
+      break;
+    }
+
+    /* Below the bricks there's only the walls to bounce off, so the gap */
+    /* can be crossed in one go, folding back off the walls on the way.  */
+    if ( l_location.y > l_bottom )
+    {
+      sim_num_t l_gap = l_step.y > sim_num_t( 0 ) ? l_floor - l_location.y : l_location.y - l_bottom;
+      int32_t   l_skip = sim_to_int( l_gap ) / AUTOPILOT_STRIDE;
+      if ( l_skip > 1 )
+      {
+        l_location += l_step * sim_num_t( l_skip );
+        while ( l_location.x < l_left || l_location.x > l_right )
+        {
+          l_location.x = l_location.x < l_left ? l_left * sim_num_t( 2 ) - l_location.x
+                                               : l_right * sim_num_t( 2 ) - l_location.x;
+          l_step.x = -l_step.x;
+        }
+        l_steps += l_skip;
+        continue;
+      }
+    }
+
+    l_location += l_step;
+    l_steps++;
+
+    /* Bounce off the walls and the top, just as the ball will. */
+    if ( ( l_location.x <= l_left && l_step.x < sim_num_t( 0 ) ) ||
+         ( l_location.x >= l_right && l_step.x > sim_num_t( 0 ) ) )
+    {
+      l_step.x = -l_step.x;
+    }
+    if ( l_location.y <= p_extent && l_step.y < sim_num_t( 0 ) )
+    {
+      l_step.y = -l_step.y;
+    }
+
+    /* And off any bricks ahead of its leading edges, if it's among them. */
+    if ( l_location.y > l_bottom )
+    {
+      continue;
+    }
+    int32_t l_x = sim_floor( l_location.x );
+    int32_t l_y = sim_floor( l_location.y );
+    int32_t l_lead_x = sim_floor( l_location.x + ( l_step.x < sim_num_t( 0 ) ? -p_extent : p_extent ) );
+    int32_t l_lead_y = sim_floor( l_location.y + ( l_step.y < sim_num_t( 0 ) ? -p_extent : p_extent ) );
+    if ( brick_at( p_field, l_lead_x, l_y ) )
+    {
+      l_step.x = -l_step.x;
+    }
+    if ( brick_at( p_field, l_x, l_lead_y ) )
+    {
+      l_step.y = -l_step.y;
+    }
+  }
+
+  *p_landing = sim_to_int( l_location.x );
+  *p_heading = l_step;
+
+  /* All done. */
+  return sim_num_t( l_steps * AUTOPILOT_STRIDE );
+}
+
+
+/*
+ * in_sight - checks if there's a clear line from the bat to a brick, so that
+ *            the ball can be sent straight there.
+ *
+ * autopilot_field_t & - the playing field
+ * int32_t             - the x where the ball is expected to land
+ * blit::Rect          - the brick being aimed for
+ */
+
+static bool in_sight( const autopilot_field_t &p_field, int32_t p_landing, blit::Rect p_brick )
+{
+  blit::Point l_centre = p_brick.center();
+  int32_t     l_rise = p_field.bat_height - l_centre.y;
+
+  /* Walk up the line a couple of strides at a time, until we reach the brick. */
+  for ( int32_t l_y = AUTOPILOT_STRIDE; l_y < l_rise; l_y += AUTOPILOT_STRIDE * 2 )
+  {
+    blit::Point l_point( p_landing + ( l_centre.x - p_landing ) * l_y / l_rise, p_field.bat_height - l_y );
+    if ( p_brick.contains( l_point ) )
+    {
+      break;
+    }
+    if ( brick_at( p_field, l_point.x, l_point.y ) )
+    {
+      return false;
+    }
+  }
+
+  /* All done. */
+  return true;
+}
+
+
+/*
+ * find_target - picks out the brick to aim for; the lowest breakable one
+ *               there's a clear shot at, being the easiest to reach, and of
+ *               those the closest.
+ *
+ * GameSim &           - the simulation being driven
+ * autopilot_field_t & - the playing field
+ * int32_t             - the x where the ball is expected to land
+ * blit::Point *       - where to store the centre of the brick
+ *
+ * Returns true if there's a brick to aim for.
+ */
+
+static bool find_target( GameSim &p_sim, const autopilot_field_t &p_field, int32_t p_landing, blit::Point *p_target )
+{
+  Level *l_level = p_sim.get_level();
+  bool   l_found = false;
+
+  for ( int32_t l_row = p_field.rows - 1; l_row >= 0 && !l_found; l_row-- )
+  {
+    for ( int32_t l_column = 0; l_column < p_field.columns; l_column++ )
+    {
+      /* Only bricks that can be broken are worth aiming for. */
+      if ( ( p_field.row_mask[l_row] & ( 1u << l_column ) ) == 0 || l_level->get_brick( l_row, l_column ) == 8 )
+      {
+        continue;
+      }
+
+      blit::Rect l_cell = p_sim.brick_to_screen( l_row, l_column );
+      if ( ( !l_found || abs( l_cell.center().x - p_landing ) < abs( p_target->x - p_landing ) ) &&
+           in_sight( p_field, p_landing, l_cell ) )
+      {
+        l_found = true;
+        *p_target = l_cell.center();
+      }
+    }
+  }
+
+  /* All done. */
+  return l_found;
+}
+
+
+/*
+ * aim_offset - works out how far from the centre of the bat the ball needs to
+ *              land, to come off it heading straight for a brick. The bounce
+ *              turns it back up, and then twists it further the further off
+ *              centre it lands; see BallT::bat_angle.
+ *
+ * GameSim &   - the simulation being driven
+ * int32_t     - the x where the ball is expected to land
+ * sim_vec_t   - the direction it'll be heading in when it does
+ * blit::Point - the centre of the brick to aim for
+ */
+
+static int32_t aim_offset( GameSim &p_sim, int32_t p_landing, sim_vec_t p_heading, blit::Point p_brick )
+{
+  blit::Rect  l_bat = p_sim.bat_bounds();
+  const float l_steps = SIM_DIRECTIONS / ( 2.0f * (float)M_PI );
+
+  /* The direction it'll come in on, and so go out on with a straight bounce. */
+  int32_t l_in = (int32_t)( atan2f( sim_to_float( p_heading.y ), sim_to_float( p_heading.x ) ) * l_steps );
+  int32_t l_straight = -l_in;
+
+  /* And the direction it needs to go out on, to reach the brick. */
+  int32_t l_wanted = (int32_t)( atan2f( (float)( p_brick.y - l_bat.y ), (float)( p_brick.x - p_landing ) ) * l_steps );
+
+  /* The difference is the twist the bat has to put on it, the short way round. */
+  int32_t l_twist = ( l_wanted - l_straight ) & SIM_DIRECTION_MASK;
+  if ( l_twist >= SIM_DIRECTIONS / 2 )
+  {
+    l_twist -= SIM_DIRECTIONS;
+  }
+
+  /* Which is made by landing that far off centre; as far as the bat allows. */
+  int32_t l_limit = l_bat.w / 2 - 2;
+  return std::min( l_limit, std::max( -l_limit, l_twist * l_bat.w / SIM_STEPS_PER_RADIAN ) );
+}
+
+
+/*
+ * autopilot - works out the input for the next tick; head for where the ball
+ *             that'll reach the bat soonest is going to land, and launch any
+ *             that are stuck.
+ *
+ * GameSim & - the simulation being driven
+ */
+
+sim_input_t autopilot( GameSim &p_sim )
+{
+  sim_input_t       l_input = { 0, 0 };
+  autopilot_field_t l_field;
+  int32_t           l_target = 0;
+  sim_num_t         l_soonest = 0;
+  sim_num_t         l_distance = 0;
+  sim_vec_t         l_heading;
+  bool              l_found = false;
+
+  /* Every ball's path gets walked through the same field. */
+  read_field( p_sim, &l_field );
+
+  /* Find the ball most in need of our attention. */
+  for ( auto l_ball : p_sim.get_balls() )
+  {
+    /* Stuck balls just need launching. */
+    if ( l_ball->stuck )
+    {
+      l_input.buttons |= SIM_INPUT_LAUNCH;
+      continue;
+    }
+
+    /* Otherwise, we care about the one that will get to us first. */
+    sim_vec_t l_vector = l_ball->get_vector();
+    int32_t   l_landing;
+    sim_vec_t l_arrival;
+    sim_num_t l_travel = predict_landing( l_field, l_ball->get_location(), l_vector,
+                                          l_ball->get_extent(), &l_landing, &l_arrival );
+    sim_num_t l_time = l_vector.y == sim_num_t( 0 ) ? sim_num_t( 0 ) : l_travel / sim_abs( l_vector.y );
+    if ( !l_found || l_time < l_soonest )
+    {
+      l_found = true;
+      l_soonest = l_time;
+      l_distance = l_travel;
+      l_target = l_landing;
+      l_heading = l_arrival;
+    }
+  }
+
+  /* Any swarm counts too; with so many balls, we can only chase one. */
+  BallSwarm &l_swarm = p_sim.get_swarm();
+  for ( uint16_t l_index = 0; l_index < l_swarm.get_count(); l_index++ )
+  {
+    sim_vec_t l_vector = l_swarm.get_vector( l_index );
+    int32_t   l_landing;
+    sim_vec_t l_arrival;
+    sim_num_t l_travel = predict_landing( l_field, l_swarm.get_location( l_index ), l_vector,
+                                          sim_num_t( SWARM_EXTENT ), &l_landing, &l_arrival );
+    sim_num_t l_time = l_vector.y == sim_num_t( 0 ) ? sim_num_t( 0 ) : l_travel / sim_abs( l_vector.y );
+    if ( !l_found || l_time < l_soonest )
+    {
+      l_found = true;
+      l_soonest = l_time;
+      l_distance = l_travel;
+      l_target = l_landing;
+      l_heading = l_arrival;
+    }
+  }
+
+  /* And steer the bat underneath it; as it gets close, off centre so that */
+  /* it comes off the bat heading for the brick we're after, as near as the */
+  /* bat can manage.                                                         */
+  if ( l_found )
+  {
+    int32_t l_aim = 0;
+    blit::Point l_brick;
+    if ( l_distance < sim_num_t( AUTOPILOT_AIM_RANGE ) && find_target( p_sim, l_field, l_target, &l_brick ) )
+    {
+      l_aim = aim_offset( p_sim, l_target, l_heading, l_brick );
+    }
+    int32_t l_offset = l_target - l_aim - sim_to_int( p_sim.get_bat_position() );
+    if ( l_offset < -2 )
+    {
+      l_input.buttons |= SIM_INPUT_LEFT;
+    }
+    else if ( l_offset > 2 )
+    {
+      l_input.buttons |= SIM_INPUT_RIGHT;
+    }
+  }
+
+  /* All done. */
+  return l_input;
+}
+
+
+/* End of Autopilot.cpp */
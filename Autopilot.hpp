@@ -0,0 +1,21 @@
+/*
+ * Autopilot.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The autopilot is a simple scripted bat controller, for driving the game
+ * simulation without a player; it's used by the headless tools.
+ */
+
+#ifndef   _AUTOPILOT_HPP_
+#define   _AUTOPILOT_HPP_
+
+#include "GameSim.hpp"
+
+sim_input_t autopilot( GameSim & );
+
+#endif /* _AUTOPILOT_HPP_ */
+
+/* End of Autopilot.hpp */
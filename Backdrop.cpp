@@ -0,0 +1,265 @@
+/*
+ * Backdrop.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The Backdrop is a singleton class that draws the gradients behind every
+ * screen. Only one gradient is kept rendered at a time, as they're the size
+ * of (a good chunk of) the screen; if there's not the memory for even that,
+ * we fall back to drawing them a line at a time.
+ */
+
+/* System headers. */
+
+#include <new>
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "Backdrop.hpp"
+
+
+/* Functions. */
+
+/*
+ * constructor - nothing is rendered until it's asked for.
+ */
+
+Backdrop::Backdrop( void )
+{
+  cached_type = BACKDROP_MAX;
+  cache_data = nullptr;
+  cache = nullptr;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * get_instance - fetches the singleton instance of the Backdrop
+ */
+
+Backdrop &Backdrop::get_instance( void )
+{
+  static Backdrop myself;
+  return myself;
+}
+
+
+/*
+ * get_period - returns how many lines a gradient has before it repeats; the
+ *              static ones simply cover the screen.
+ *
+ * backdrop_t - the gradient in question
+ */
+
+uint16_t Backdrop::get_period( backdrop_t p_type )
+{
+  switch( p_type )
+  {
+    case BACKDROP_TITLE:
+    case BACKDROP_HISCORE:
+      return BACKDROP_SCROLL_HEIGHT;
+    default:
+      return blit::screen.bounds.h;
+  }
+}
+
+
+/*
+ * line_pen - works out the colour of a single line of a gradient. The
+ *            scrolling ones fade one way and then back again, so that they
+ *            wrap around without a seam.
+ *
+ * backdrop_t - the gradient being drawn
+ * uint16_t   - the line of it, from 0 to the period
+ */
+
+blit::Pen Backdrop::line_pen( backdrop_t p_type, uint16_t p_line )
+{
+  uint16_t l_fold = ( p_line < BACKDROP_SCROLL_HEIGHT / 2 ) ? p_line : BACKDROP_SCROLL_HEIGHT - p_line - 1;
+  uint16_t l_fade = ( blit::screen.bounds.h - p_line ) / 2;
+
+  switch( p_type )
+  {
+    case BACKDROP_TITLE:
+      return blit::Pen( 40 - l_fold / 2, 10 + l_fold, 30 + l_fold / 2 );
+    case BACKDROP_HISCORE:
+      return blit::Pen( 10 + l_fold, 40 - l_fold / 2, 30 + l_fold / 2 );
+    case BACKDROP_GAME:
+      return blit::Pen( 10, 10, l_fade );
+    case BACKDROP_DEATH:
+      return blit::Pen( l_fade, 10, 10 );
+    default:
+      return blit::Pen( 0, 0, 0 );
+  }
+}
+
+
+/*
+ * draw - draws part of a gradient onto a surface, a line at a time; this is
+ *        how the cached copy gets made, and is also handy for anything that
+ *        keeps its own copy of the background.
+ *
+ * backdrop_t      - the gradient to draw
+ * blit::Surface * - the surface to draw onto
+ * blit::Rect      - the area of the surface to fill
+ * uint16_t        - how far the gradient has scrolled
+ */
+
+void Backdrop::draw( backdrop_t p_type, blit::Surface *p_surface, blit::Rect p_rect, uint16_t p_offset )
+{
+  uint16_t l_period = get_period( p_type );
+
+  for ( int32_t l_line = p_rect.y; l_line < p_rect.y + p_rect.h; l_line++ )
+  {
+    p_surface->pen = line_pen( p_type, ( l_line + p_offset ) % l_period );
+    p_surface->h_span( blit::Point( p_rect.x, l_line ), p_rect.w );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * prepare - makes sure the given gradient is the one that's cached, rendering
+ *           it if it isn't.
+ *
+ * backdrop_t - the gradient we want
+ *
+ * Returns true if it's ready to copy, false if there wasn't the memory.
+ */
+
+bool Backdrop::prepare( backdrop_t p_type )
+{
+  /* If it's already there, and still the right shape, there's nothing to do. */
+  if ( cache != nullptr && cached_type == p_type &&
+       cache->bounds.w == blit::screen.bounds.w && cache->format == blit::screen.format )
+  {
+    return true;
+  }
+
+  /* Otherwise, throw away whatever we had and start again. */
+  release();
+  blit::Size l_size( blit::screen.bounds.w, get_period( p_type ) );
+  cache_data = new( std::nothrow ) uint8_t[l_size.w * l_size.h * blit::screen.pixel_stride];
+  if ( cache_data == nullptr )
+  {
+    return false;
+  }
+  cache = new blit::Surface( cache_data, blit::screen.format, l_size );
+  draw( p_type, cache, blit::Rect( blit::Point( 0, 0 ), l_size ) );
+  cached_type = p_type;
+
+  return true;
+}
+
+
+/*
+ * render - fills the screen with a gradient; the cached copy is a ring of
+ *          lines, so this is one copy from the offset to the end of it, and
+ *          then as many more from the start as it takes to fill the screen.
+ *
+ * backdrop_t - the gradient to draw
+ * uint16_t   - how far the gradient has scrolled
+ */
+
+void Backdrop::render( backdrop_t p_type, uint16_t p_offset )
+{
+  /* If we can't have a copy, we'll have to do it the slow way. */
+  if ( !prepare( p_type ) )
+  {
+    draw( p_type, &blit::screen, blit::Rect( blit::Point( 0, 0 ), blit::screen.bounds ), p_offset );
+    return;
+  }
+
+  uint32_t l_stride = blit::screen.bounds.w * blit::screen.pixel_stride;
+  uint16_t l_period = get_period( p_type );
+  uint16_t l_source = p_offset % l_period;
+  int32_t  l_line = 0;
+
+  while( l_line < blit::screen.bounds.h )
+  {
+    int32_t l_count = l_period - l_source;
+    if ( l_count > blit::screen.bounds.h - l_line )
+    {
+      l_count = blit::screen.bounds.h - l_line;
+    }
+    memcpy( blit::screen.data + l_line * l_stride, cache_data + l_source * l_stride, l_count * l_stride );
+    l_line += l_count;
+    l_source = 0;
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * render - puts the gradient back over just part of the screen, for screens
+ *          that only redraw what's changed.
+ *
+ * backdrop_t - the gradient to draw
+ * uint16_t   - how far the gradient has scrolled
+ * blit::Rect - the area of the screen to cover
+ */
+
+void Backdrop::render( backdrop_t p_type, uint16_t p_offset, blit::Rect p_rect )
+{
+  blit::Rect l_rect = p_rect.intersection( blit::Rect( blit::Point( 0, 0 ), blit::screen.bounds ) );
+  if ( l_rect.empty() )
+  {
+    return;
+  }
+
+  /* If we can't have a copy, we'll have to do it the slow way. */
+  if ( !prepare( p_type ) )
+  {
+    draw( p_type, &blit::screen, l_rect, p_offset );
+    return;
+  }
+
+  /* Otherwise it's a copy of part of each line, from wherever in the ring. */
+  uint32_t l_stride = blit::screen.bounds.w * blit::screen.pixel_stride;
+  uint32_t l_left = l_rect.x * blit::screen.pixel_stride;
+  uint32_t l_width = l_rect.w * blit::screen.pixel_stride;
+  uint16_t l_period = get_period( p_type );
+
+  for ( int32_t l_line = l_rect.y; l_line < l_rect.y + l_rect.h; l_line++ )
+  {
+    memcpy( blit::screen.data + l_line * l_stride + l_left,
+            cache_data + ( ( l_line + p_offset ) % l_period ) * l_stride + l_left, l_width );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * release - throws away the cached gradient, to free up the memory; it'll be
+ *           rendered again next time it's needed.
+ */
+
+void Backdrop::release( void )
+{
+  delete cache;
+  delete[] cache_data;
+  cache = nullptr;
+  cache_data = nullptr;
+  cached_type = BACKDROP_MAX;
+
+  /* All done. */
+  return;
+}
+
+
+/* End of Backdrop.cpp */
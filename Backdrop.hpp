@@ -0,0 +1,51 @@
+/*
+ * Backdrop.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The Backdrop is a singleton class that draws the gradients behind every
+ * screen. Each gradient is rendered into a surface once, when it's first
+ * needed, and then simply copied onto the screen; the scrolling ones are kept
+ * as a ring of lines, so scrolling is just a case of where the copy starts.
+ */
+
+#ifndef   _BACKDROP_HPP_
+#define   _BACKDROP_HPP_
+
+/* The scrolling gradients repeat every this many lines. */
+#define BACKDROP_SCROLL_HEIGHT  160
+
+typedef enum
+{
+  BACKDROP_TITLE,
+  BACKDROP_HISCORE,
+  BACKDROP_GAME,
+  BACKDROP_DEATH,
+  BACKDROP_MAX
+} backdrop_t;
+
+class Backdrop
+{
+private:
+                        Backdrop( void );
+  backdrop_t            cached_type;
+  uint8_t              *cache_data;
+  blit::Surface        *cache;
+  blit::Pen             line_pen( backdrop_t, uint16_t );
+  bool                  prepare( backdrop_t );
+
+public:
+  static Backdrop      &get_instance( void );
+  uint16_t              get_period( backdrop_t );
+  void                  render( backdrop_t, uint16_t = 0 );
+  void                  render( backdrop_t, uint16_t, blit::Rect );
+  void                  draw( backdrop_t, blit::Surface *, blit::Rect, uint16_t = 0 );
+  void                  release( void );
+};
+
+
+#endif /* _BACKDROP_HPP_ */
+
+/* End of Backdrop.hpp */
@@ -25,18 +25,24 @@
 
 /*
  * constructor - Spawns a ball at the specified location, of the specfied type
+ *
+ * uint16_t - the width of the playing field, which the ball is confined to.
  */
 
-Ball::Ball( blit::Point p_origin, float p_speed, ball_type_t p_type )
+template <typename T>
+BallT<T>::BallT( blit::Point p_origin, uint16_t p_field_width, T p_speed, ball_type_t p_type )
 {
   /* Save the origin and type. */
   location.x = p_origin.x;
   location.y = p_origin.y;
+  last_location = location;
   ball_type = p_type;
   speed = p_speed;
+  field_width = p_field_width;
 
   /* And set some defaults, for now. */
-  vector = blit::Vec2( 0, 0 );
+  vector = SimVec<T>( 0, 0 );
+  direction = SIM_DIRECTION_UP;
   bat_position = blit::Rect( 0, 0, 0, 0 );
   stuck = false;
 
@@ -46,34 +52,51 @@ Ball::Ball( blit::Point p_origin, float p_speed, ball_type_t p_type )
 
 
 /*
- * compute_bat_angle - works out the (radian) angle from vertical to rotate
- *                     a bat bounce from; the central zone is a straight bounce,
- *                     but close to the edge we rotate downwards a little
+ * compute_bat_angle - works out the angle (in direction steps) from vertical
+ *                     to rotate a bat bounce from, for wherever we are now.
  */
 
-float Ball::compute_bat_angle( void )
+template <typename T>
+int16_t BallT<T>::compute_bat_angle( void )
 {
-  /* So, work out the centre of the bat. */
-  uint16_t l_bat_centre = bat_position.x + bat_position.w / 2;
+  return bat_angle( location.x, bat_position );
+}
 
-  /* And the ratio away from the centre we are. */
-  float l_offset = ( location.x - l_bat_centre ) / (float)bat_position.w;
 
-  /* So, this is the angle to twist at... */
-  return l_offset;
+/*
+ * set_direction - points the ball in a new direction, at its usual speed; the
+ *                 vector comes straight out of the direction table.
+ *
+ * int32_t - the new direction, in steps; any number of turns is fine.
+ */
+
+template <typename T>
+void BallT<T>::set_direction( int32_t p_direction )
+{
+  direction = p_direction & SIM_DIRECTION_MASK;
+  vector = sim_direction<T>( direction ) * speed;
+
+  /* All done. */
+  return;
 }
 
 
 /*
  * get_render_location - returns the render location of the ball, taking into
  *                       account the ball time and offsets and suchlike.
+ *
+ * T - how far through the current tick we are; the ball is drawn that far
+ *     between where it was at the last tick, and where it is now.
  */
 
-blit::Point Ball::get_render_location( void )
+template <typename T>
+blit::Point BallT<T>::get_render_location( T p_fraction )
 {
+  SimVec<T> l_location = last_location + ( location - last_location ) * p_fraction;
+
   /* The inner location represents the middle of the ball; every type of ball */
   /* (currently) fits into one sprite, so just move half a sprite up/left.    */
-  return location - blit::Vec2( 4, 4 );
+  return ( l_location - SimVec<T>( 4, 4 ) ).to_point();
 }
 
 
@@ -83,20 +106,21 @@ blit::Point Ball::get_render_location( void )
  *              dirty collision detection (the best kind).
  */
 
-blit::Rect Ball::get_bounds( void )
+template <typename T>
+blit::Rect BallT<T>::get_bounds( void )
 {
   /* Work out the corners. */
-  blit::Point l_tl = location - blit::Vec2( ball_size[ball_type] / 2 - 1, ball_size[ball_type] / 2 - 1 );
-  blit::Point l_br = location + blit::Vec2( ball_size[ball_type] / 2 - 1, ball_size[ball_type] / 2 - 1 );
+  blit::Point l_tl = ( location - SimVec<T>( ball_size[ball_type] / 2 - 1, ball_size[ball_type] / 2 - 1 ) ).to_point();
+  blit::Point l_br = ( location + SimVec<T>( ball_size[ball_type] / 2 - 1, ball_size[ball_type] / 2 - 1 ) ).to_point();
 
   /* Clamp the left/right edges of the screen - unsigned, so may have wrapped. */
-  if ( ( l_tl.x < 0 ) || ( l_tl.x > blit::screen.bounds.w ) )
+  if ( ( l_tl.x < 0 ) || ( l_tl.x > field_width ) )
   {
     l_tl.x = 0;
   }
-  if ( l_br.x > blit::screen.bounds.w )
+  if ( l_br.x > field_width )
   {
-    l_br.x = blit::screen.bounds.w;
+    l_br.x = field_width;
   }
 
   /* And return the resulting rectangle. */
@@ -104,11 +128,46 @@ blit::Rect Ball::get_bounds( void )
 }
 
 
+/*
+ * get_location - returns the exact location of the centre of the ball.
+ */
+
+template <typename T>
+SimVec<T> BallT<T>::get_location( void )
+{
+  return location;
+}
+
+
+/*
+ * get_vector - returns the distance the ball moves each update.
+ */
+
+template <typename T>
+SimVec<T> BallT<T>::get_vector( void )
+{
+  return vector;
+}
+
+
+/*
+ * get_extent - returns the distance from the centre of the ball to the edges
+ *              of its bounding box; the same box that get_bounds describes.
+ */
+
+template <typename T>
+T BallT<T>::get_extent( void )
+{
+  return ball_size[ball_type] / 2 - 1;
+}
+
+
 /*
  * get_type - accessor for the ball type
  */
 
-ball_type_t Ball::get_type( void )
+template <typename T>
+ball_type_t BallT<T>::get_type( void )
 {
   return ball_type;
 }
@@ -118,13 +177,15 @@ ball_type_t Ball::get_type( void )
  * moving_up and _left; boolean flags to show the balls current direction of travel
  */
 
-bool Ball::moving_up( void )
+template <typename T>
+bool BallT<T>::moving_up( void )
 {
-  return vector.y < 0.0f;
+  return vector.y < T( 0 );
 }
-bool Ball::moving_left( void )
+template <typename T>
+bool BallT<T>::moving_left( void )
 {
-  return vector.x < 0.0f;
+  return vector.x < T( 0 );
 }
 
 
@@ -132,7 +193,8 @@ bool Ball::moving_left( void )
  * update - moves the ball along it's defined vectore
  */
 
-void Ball::update( void )
+template <typename T>
+void BallT<T>::update( void )
 {
   /* This is relatively painless, actually. */
   location += vector;
@@ -143,16 +205,17 @@ void Ball::update( void )
 
 
 /*
- * render - draw the ball in it's current position / type
+ * snapshot - remembers where the ball is at the start of a tick, so that it
+ *            can be drawn part way between ticks.
  */
 
-void Ball::render( void )
+template <typename T>
+void BallT<T>::snapshot( void )
 {
-  /* We know all we need to know about ourselves! */
-  blit::screen.sprite(
-    blit::Rect( ball_type, SPRITE_ROW_BALL, 1, 1 ),
-    get_render_location()
-  );
+  last_location = location;
+
+  /* All done. */
+  return;
 }
 
 
@@ -162,14 +225,11 @@ void Ball::render( void )
  *          bat it is...
  */
 
-void Ball::launch( void )
+template <typename T>
+void BallT<T>::launch( void )
 {
-  /* First off, start with a launch-speed vertical vector. */
-  vector.x = 0;
-  vector.y = speed * -1.0f;
-
-  /* And apply a launch angle to that. */
-  vector.rotate( compute_bat_angle() );
+  /* Start off heading straight up, and apply a launch angle to that. */
+  set_direction( SIM_DIRECTION_UP + compute_bat_angle() );
 
   /* This means we're unstuck. */
   stuck = false;
@@ -181,16 +241,14 @@ void Ball::launch( void )
 
 /*
  * randomise - sets the ball vector to a random (upwards) direction
+ *
+ * uint32_t - a random number, drawn from whoever owns the ball.
  */
 
-void Ball::randomise( void )
+template <typename T>
+void BallT<T>::randomise( uint32_t p_random )
 {
-  /* First off, start with a launch-speed vertical vector. */
-  vector.x = 0;
-  vector.y = speed * -1.0f;
-
-  /* And apply a random angle to it. */
-  vector.rotate( (float)( blit::random() % 180 ) / 100.0f - 0.9f );
+  set_direction( random_direction( p_random ) );
 
   /* All done. */
   return;
@@ -203,36 +261,10 @@ void Ball::randomise( void )
  * bool - a flag to indicate a horizontal (true) or vertical (false) bounce
  */
 
-void Ball::bounce( bool p_horizontal )
+template <typename T>
+void BallT<T>::bounce( bool p_horizontal )
 {
-  /* Also fairly easy, thanks to vectors. */
-  if ( p_horizontal )
-  {
-    vector.x *= -1;
-  }
-  else
-  {
-    vector.y *= -1;
-  }
-
-  /* Sanity check, we should never end up *too* horizontal (<30 degrees) */
-  float l_current_angle = vector.angle( blit::Vec2( 1, 0 ) );
-  if ( fabsf( l_current_angle ) > 2.6f )
-  {
-    l_current_angle = vector.angle( blit::Vec2( -1, 0 ) );
-  }
-  if ( fabsf( l_current_angle ) < 0.5f )
-  {
-    /* Rotate a bit further toward vertical then. */
-    if ( l_current_angle < 0.0f )
-    {
-      vector.rotate( 0.5f + l_current_angle );
-    }
-    else
-    {
-      vector.rotate( l_current_angle - 0.5f );
-    }
-  }
+  set_direction( bounce_direction( direction, p_horizontal ) );
 
   /* All done. */
   return;
@@ -248,7 +280,8 @@ void Ball::bounce( bool p_horizontal )
  * Returns a bool flag to indicate whether this was, indeed, a bounce
  */
 
-bool Ball::bat_bounce( uint16_t p_bat_height, bool p_sticky )
+template <typename T>
+bool BallT<T>::bat_bounce( uint16_t p_bat_height, bool p_sticky )
 {
   /* Sanity check; nothing to do if the ball is already stuck to the bat. */
   if ( stuck )
@@ -259,7 +292,7 @@ bool Ball::bat_bounce( uint16_t p_bat_height, bool p_sticky )
   /* Only consider this bounce if (a) we weren't on the bat before, and (b) */
   /* we are now.                                                            */
   blit::Rect l_bounds = get_bounds();
-  if ( l_bounds.br().y < p_bat_height || ( l_bounds.br().y - vector.y ) >= p_bat_height )
+  if ( l_bounds.br().y < p_bat_height || ( T( l_bounds.br().y ) - vector.y ) >= T( p_bat_height ) )
   {
     return false;
   }
@@ -269,8 +302,8 @@ bool Ball::bat_bounce( uint16_t p_bat_height, bool p_sticky )
   {
     /* Just set a flag to say we're stuck, and zero the vector. */
     stuck = true;
-    vector.x = vector.y = 0;
-    location.y -= l_bounds.bl().y - bat_position.y;
+    vector.x = vector.y = T( 0 );
+    location.y -= T( l_bounds.bl().y - bat_position.y );
   }
   else
   {
@@ -278,7 +311,7 @@ bool Ball::bat_bounce( uint16_t p_bat_height, bool p_sticky )
     bounce( false );
 
     /* And apply a suitable rotation, too. */
-    vector.rotate( compute_bat_angle() );
+    set_direction( direction + compute_bat_angle() );
   }
 
   /* All done. */
@@ -291,7 +324,8 @@ bool Ball::bat_bounce( uint16_t p_bat_height, bool p_sticky )
  *          moving the ball outside of it's normal vectoring.
  */
 
-void Ball::offset( blit::Vec2 p_offset )
+template <typename T>
+void BallT<T>::offset( SimVec<T> p_offset )
 {
   /* Nice and simple. */
   location += p_offset;
@@ -304,11 +338,12 @@ void Ball::offset( blit::Vec2 p_offset )
 /*
  * move_bat - handles the bat moving, if we happen to be stuck to it
  * Rect     - the location of the current bat
- * float    - the offset by which the bat has moved
+ * T        - the offset by which the bat has moved
  * bool     - whether the bat is sticky
  */
 
-void Ball::move_bat( blit::Rect p_bat, float p_offset, bool p_sticky )
+template <typename T>
+void BallT<T>::move_bat( blit::Rect p_bat, T p_offset, bool p_sticky )
 {
   /* Remeber the position of the bat, we'll often need it. */
   bat_position = p_bat;
@@ -320,7 +355,7 @@ void Ball::move_bat( blit::Rect p_bat, float p_offset, bool p_sticky )
   }
 
   /* And if there's no movement, there's nothing to do. */
-  if ( p_offset == 0.0f )
+  if ( p_offset == T( 0 ) )
   {
     return;
   }
@@ -338,13 +373,13 @@ void Ball::move_bat( blit::Rect p_bat, float p_offset, bool p_sticky )
       location.x += p_offset;
 
       /* But make sure we're still on the screen. */
-      if ( location.x < ball_size[ball_type] / 2 )
+      if ( location.x < T( ball_size[ball_type] / 2 ) )
       {
-        location.x = ball_size[ball_type] / 2;
+        location.x = T( ball_size[ball_type] / 2 );
       }
-      if ( location.x > blit::screen.bounds.w - ball_size[ball_type] / 2 )
+      if ( location.x > T( field_width - ball_size[ball_type] / 2 ) )
       {
-        location.x = blit::screen.bounds.w - ball_size[ball_type] / 2;
+        location.x = T( field_width - ball_size[ball_type] / 2 );
       }
     }
 
@@ -358,4 +393,107 @@ void Ball::move_bat( blit::Rect p_bat, float p_offset, bool p_sticky )
 }
 
 
+/*
+ * hash - folds the state of the ball into a running hash, so that replays
+ *        can spot the exact moment that things start to differ.
+ *
+ * uint32_t - the hash so far
+ */
+
+template <typename T>
+uint32_t BallT<T>::hash( uint32_t p_hash )
+{
+  p_hash = hash_fnv1a( p_hash, &location, sizeof( location ) );
+  p_hash = hash_fnv1a( p_hash, &vector, sizeof( vector ) );
+  p_hash = hash_fnv1a( p_hash, &direction, sizeof( direction ) );
+  p_hash = hash_fnv1a( p_hash, &stuck, sizeof( stuck ) );
+  return p_hash;
+}
+
+
+/*
+ * random_direction - picks a random (upwards) direction; straight up, with up
+ *                    to 0.9 radians either way applied to it.
+ *
+ * uint32_t - a random number, drawn from whoever owns the ball.
+ */
+
+template <typename T>
+uint16_t BallT<T>::random_direction( uint32_t p_random )
+{
+  return ( SIM_DIRECTION_UP + ( (int32_t)( p_random % 180 ) - 90 ) * SIM_STEPS_PER_RADIAN / 100 ) & SIM_DIRECTION_MASK;
+}
+
+
+/*
+ * bounce_direction - works out the direction a ball leaves a straight bounce
+ *                    in; never *too* horizontal, or it'd take forever.
+ *
+ * uint16_t - the direction the ball arrived in
+ * bool     - a flag to indicate a horizontal (true) or vertical (false) bounce
+ */
+
+template <typename T>
+uint16_t BallT<T>::bounce_direction( uint16_t p_direction, bool p_horizontal )
+{
+  int32_t  l_direction;
+  uint16_t l_from_horizontal;
+
+  /* Also fairly easy, thanks to directions; a horizontal bounce mirrors us */
+  /* around the vertical, and a vertical one around the horizontal.         */
+  if ( p_horizontal )
+  {
+    l_direction = ( SIM_DIRECTIONS / 2 - p_direction ) & SIM_DIRECTION_MASK;
+  }
+  else
+  {
+    l_direction = ( SIM_DIRECTIONS - p_direction ) & SIM_DIRECTION_MASK;
+  }
+
+  /* Sanity check, we should never end up *too* horizontal (<30 degrees) */
+  l_from_horizontal = l_direction % ( SIM_DIRECTIONS / 2 );
+  if ( l_from_horizontal < BALL_MIN_ANGLE )
+  {
+    /* Rotate a bit further toward vertical then. */
+    l_direction += BALL_MIN_ANGLE - l_from_horizontal;
+  }
+  else if ( l_from_horizontal > SIM_DIRECTIONS / 2 - BALL_MIN_ANGLE )
+  {
+    l_direction -= l_from_horizontal - ( SIM_DIRECTIONS / 2 - BALL_MIN_ANGLE );
+  }
+
+  return l_direction & SIM_DIRECTION_MASK;
+}
+
+
+/*
+ * bat_angle - works out the angle (in direction steps) from vertical to
+ *             rotate a bat bounce from; the central zone is a straight
+ *             bounce, but close to the edge we rotate downwards a little
+ *
+ * T          - the horizontal position of the centre of the ball
+ * blit::Rect - the bounds of the bat
+ */
+
+template <typename T>
+int16_t BallT<T>::bat_angle( T p_x, blit::Rect p_bat )
+{
+  /* So, work out the centre of the bat. */
+  uint16_t l_bat_centre = p_bat.x + p_bat.w / 2;
+
+  /* And the ratio away from the centre we are; that's the angle to twist */
+  /* at, in radians, so scale it up into steps.                           */
+  T l_offset = ( p_x - T( l_bat_centre ) ) * T( SIM_STEPS_PER_RADIAN ) / T( p_bat.w );
+
+  /* So, this is the angle to twist at... */
+  return sim_to_int( l_offset );
+}
+
+
+/* The physics is built for both number types, so that either can be used. */
+
+template class BallT<float>;
+template class BallT<Fixed>;
+
+
 /* End of Ball.cpp */
@@ -11,6 +11,8 @@
 #ifndef   _BALL_HPP_
 #define   _BALL_HPP_
 
+#include "SimMath.hpp"
+
 typedef enum
 {
   BALL_NORMAL,
@@ -18,36 +20,56 @@ typedef enum
   BALL_MAX
 } ball_type_t;
 
-class Ball
+/* Balls are never allowed to travel closer to horizontal than this many */
+/* direction steps (about half a radian), or they'd take forever.        */
+#define BALL_MIN_ANGLE  81
+
+/* The ball physics is written against a number type; see SimMath.hpp. */
+template <typename T>
+class BallT
 {
 private:
-  blit::Vec2    location;
-  blit::Vec2    vector;
-  float         speed;
+  SimVec<T>     location;
+  SimVec<T>     last_location;
+  SimVec<T>     vector;
+  uint16_t      direction;
+  T             speed;
   ball_type_t   ball_type;
   blit::Rect    bat_position;
+  uint16_t      field_width;
   const uint8_t ball_size[BALL_MAX] = { 8, 6 };
-  float         compute_bat_angle( void );
-  blit::Point   get_render_location( void );
+  int16_t       compute_bat_angle( void );
+  void          set_direction( int32_t );
 
 public:
-                Ball( blit::Point, float = 1.5, ball_type_t = BALL_NORMAL );
+                BallT( blit::Point, uint16_t, T = T( 1.5f ), ball_type_t = BALL_NORMAL );
   blit::Rect    get_bounds( void );
+  blit::Point   get_render_location( T = T( 1 ) );
+  SimVec<T>     get_location( void );
+  SimVec<T>     get_vector( void );
+  T             get_extent( void );
   ball_type_t   get_type( void );
   bool          moving_up( void );
   bool          moving_left( void );
   void          update( void );
-  void          render( void );
+  void          snapshot( void );
   void          launch( void );
-  void          randomise( void );
+  void          randomise( uint32_t );
   void          bounce( bool );
   bool          bat_bounce( uint16_t, bool );
-  void          offset( blit::Vec2 );
-  void          move_bat( blit::Rect, float, bool );
+  void          offset( SimVec<T> );
+  void          move_bat( blit::Rect, T, bool );
+  uint32_t      hash( uint32_t );
+
+  static uint16_t random_direction( uint32_t );
+  static uint16_t bounce_direction( uint16_t, bool );
+  static int16_t  bat_angle( T, blit::Rect );
 
   bool          stuck;
 };
 
+typedef BallT<sim_num_t> Ball;
+
 #endif /* _BALL_HPP_ */
 
 /* End of Ball.hpp */
@@ -0,0 +1,433 @@
+/*
+ * BallSwarm.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The BallSwarm keeps a mega multiball's worth of balls in flat arrays. The
+ * bulk work - moving every ball, and checking which ones are anywhere near
+ * something they could hit - is done four balls at a time, with SSE2 on
+ * desktops and NEON where the ARM has it; the 32blit's M7 and the PicoSystem
+ * have neither, so they get the plain loops, which give the same answers.
+ */
+
+
+/* System headers. */
+
+#include <algorithm>
+#include <string.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define SWARM_SSE2
+#include <emmintrin.h>
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#define SWARM_NEON
+#include <arm_neon.h>
+#endif
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "BallSwarm.hpp"
+
+
+#if SWARM_MAX_BALLS % 4 != 0
+#error "SWARM_MAX_BALLS must be a multiple of four"
+#endif
+
+
+/* Lanes. */
+
+/* Four numbers at a time, whichever number type we're using; fixed point is */
+/* just integer sums on the raw values. Comparisons give a mask per lane, of  */
+/* all ones where true, so they can be turned into flags with a simple and.   */
+
+#if defined( SWARM_SSE2 )
+
+typedef __m128i swarm_mask_t;
+
+#ifdef    BLOX_FIXED_POINT
+typedef __m128i swarm_lane_t;
+static inline swarm_lane_t lane_load( const sim_num_t *p_from ) { return _mm_load_si128( (const __m128i *)p_from ); }
+static inline void lane_store( sim_num_t *p_to, swarm_lane_t p_lane ) { _mm_store_si128( (__m128i *)p_to, p_lane ); }
+static inline swarm_lane_t lane_add( swarm_lane_t a, swarm_lane_t b ) { return _mm_add_epi32( a, b ); }
+static inline swarm_lane_t lane_splat( sim_num_t p_value ) { return _mm_set1_epi32( p_value.raw ); }
+static inline swarm_mask_t lane_lt( swarm_lane_t a, swarm_lane_t b ) { return _mm_cmplt_epi32( a, b ); }
+static inline swarm_mask_t lane_le( swarm_lane_t a, swarm_lane_t b ) { return _mm_andnot_si128( _mm_cmpgt_epi32( a, b ), _mm_set1_epi32( -1 ) ); }
+#else
+typedef __m128 swarm_lane_t;
+static inline swarm_lane_t lane_load( const sim_num_t *p_from ) { return _mm_load_ps( p_from ); }
+static inline void lane_store( sim_num_t *p_to, swarm_lane_t p_lane ) { _mm_store_ps( p_to, p_lane ); }
+static inline swarm_lane_t lane_add( swarm_lane_t a, swarm_lane_t b ) { return _mm_add_ps( a, b ); }
+static inline swarm_lane_t lane_splat( sim_num_t p_value ) { return _mm_set1_ps( p_value ); }
+static inline swarm_mask_t lane_lt( swarm_lane_t a, swarm_lane_t b ) { return _mm_castps_si128( _mm_cmplt_ps( a, b ) ); }
+static inline swarm_mask_t lane_le( swarm_lane_t a, swarm_lane_t b ) { return _mm_castps_si128( _mm_cmple_ps( a, b ) ); }
+#endif /* BLOX_FIXED_POINT */
+
+static inline swarm_mask_t mask_and( swarm_mask_t a, swarm_mask_t b ) { return _mm_and_si128( a, b ); }
+static inline swarm_mask_t mask_or( swarm_mask_t a, swarm_mask_t b ) { return _mm_or_si128( a, b ); }
+static inline swarm_mask_t mask_flag( swarm_mask_t a, uint8_t p_flag ) { return _mm_and_si128( a, _mm_set1_epi32( p_flag ) ); }
+static inline void mask_store_flags( uint8_t *p_to, swarm_mask_t p_mask )
+{
+  /* Squash each lane down to a byte; the flags all fit, so nothing saturates. */
+  __m128i l_words = _mm_packs_epi32( p_mask, p_mask );
+  __m128i l_bytes = _mm_packus_epi16( l_words, l_words );
+  int32_t l_packed = _mm_cvtsi128_si32( l_bytes );
+  memcpy( p_to, &l_packed, 4 );
+}
+
+#elif defined( SWARM_NEON )
+
+typedef uint32x4_t swarm_mask_t;
+
+#ifdef    BLOX_FIXED_POINT
+typedef int32x4_t swarm_lane_t;
+static inline swarm_lane_t lane_load( const sim_num_t *p_from ) { return vld1q_s32( (const int32_t *)p_from ); }
+static inline void lane_store( sim_num_t *p_to, swarm_lane_t p_lane ) { vst1q_s32( (int32_t *)p_to, p_lane ); }
+static inline swarm_lane_t lane_add( swarm_lane_t a, swarm_lane_t b ) { return vaddq_s32( a, b ); }
+static inline swarm_lane_t lane_splat( sim_num_t p_value ) { return vdupq_n_s32( p_value.raw ); }
+static inline swarm_mask_t lane_lt( swarm_lane_t a, swarm_lane_t b ) { return vcltq_s32( a, b ); }
+static inline swarm_mask_t lane_le( swarm_lane_t a, swarm_lane_t b ) { return vcleq_s32( a, b ); }
+#else
+typedef float32x4_t swarm_lane_t;
+static inline swarm_lane_t lane_load( const sim_num_t *p_from ) { return vld1q_f32( p_from ); }
+static inline void lane_store( sim_num_t *p_to, swarm_lane_t p_lane ) { vst1q_f32( p_to, p_lane ); }
+static inline swarm_lane_t lane_add( swarm_lane_t a, swarm_lane_t b ) { return vaddq_f32( a, b ); }
+static inline swarm_lane_t lane_splat( sim_num_t p_value ) { return vdupq_n_f32( p_value ); }
+static inline swarm_mask_t lane_lt( swarm_lane_t a, swarm_lane_t b ) { return vcltq_f32( a, b ); }
+static inline swarm_mask_t lane_le( swarm_lane_t a, swarm_lane_t b ) { return vcleq_f32( a, b ); }
+#endif /* BLOX_FIXED_POINT */
+
+static inline swarm_mask_t mask_and( swarm_mask_t a, swarm_mask_t b ) { return vandq_u32( a, b ); }
+static inline swarm_mask_t mask_or( swarm_mask_t a, swarm_mask_t b ) { return vorrq_u32( a, b ); }
+static inline swarm_mask_t mask_flag( swarm_mask_t a, uint8_t p_flag ) { return vandq_u32( a, vdupq_n_u32( p_flag ) ); }
+static inline void mask_store_flags( uint8_t *p_to, swarm_mask_t p_mask )
+{
+  /* Narrow each lane down to a byte; the flags all fit, so nothing is lost. */
+  uint16x4_t l_halves = vmovn_u32( p_mask );
+  uint8x8_t  l_bytes = vmovn_u16( vcombine_u16( l_halves, l_halves ) );
+  uint32_t   l_packed = vget_lane_u32( vreinterpret_u32_u8( l_bytes ), 0 );
+  memcpy( p_to, &l_packed, 4 );
+}
+
+#endif /* SWARM_SSE2 / SWARM_NEON */
+
+
+/* Functions. */
+
+/*
+ * constructor - sets up an empty swarm; everything is zeroed, as the lanes
+ *               past the last ball still get worked on.
+ */
+
+BallSwarm::BallSwarm( void )
+{
+  std::fill( x, x + SWARM_MAX_BALLS, sim_num_t( 0 ) );
+  std::fill( y, y + SWARM_MAX_BALLS, sim_num_t( 0 ) );
+  std::fill( vx, vx + SWARM_MAX_BALLS, sim_num_t( 0 ) );
+  std::fill( vy, vy + SWARM_MAX_BALLS, sim_num_t( 0 ) );
+  std::fill( last_x, last_x + SWARM_MAX_BALLS, sim_num_t( 0 ) );
+  std::fill( last_y, last_y + SWARM_MAX_BALLS, sim_num_t( 0 ) );
+  memset( direction, 0, sizeof( direction ) );
+  memset( flags, 0, sizeof( flags ) );
+  count = 0;
+  speed = sim_num_t( 1 );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * clear - gets rid of every ball, ready for a new level.
+ *
+ * sim_num_t - the speed that balls travel at, on this level.
+ */
+
+void BallSwarm::clear( sim_num_t p_speed )
+{
+  count = 0;
+  speed = p_speed;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * add - lets another ball loose, if there's room for it.
+ *
+ * sim_vec_t - where the centre of the ball starts
+ * uint16_t  - the direction it heads off in
+ *
+ * Returns true if the ball was added.
+ */
+
+bool BallSwarm::add( sim_vec_t p_location, uint16_t p_direction )
+{
+  /* No room, no ball. */
+  if ( count >= SWARM_MAX_BALLS )
+  {
+    return false;
+  }
+
+  /* Just pop it on the end. */
+  x[count] = last_x[count] = p_location.x;
+  y[count] = last_y[count] = p_location.y;
+  flags[count] = 0;
+  set_direction( count, p_direction );
+  count++;
+
+  return true;
+}
+
+
+/*
+ * remove - gets rid of a ball; the last ball is moved into its place, so it
+ *          should be done walking backwards through the swarm.
+ *
+ * uint16_t - the index of the ball to remove
+ */
+
+void BallSwarm::remove( uint16_t p_index )
+{
+  count--;
+  x[p_index] = x[count];
+  y[p_index] = y[count];
+  vx[p_index] = vx[count];
+  vy[p_index] = vy[count];
+  last_x[p_index] = last_x[count];
+  last_y[p_index] = last_y[count];
+  direction[p_index] = direction[count];
+  flags[p_index] = flags[count];
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * integrate - moves every ball along its vector.
+ */
+
+void BallSwarm::integrate( void )
+{
+#if defined( SWARM_SSE2 ) || defined( SWARM_NEON )
+  /* Four at a time; the arrays are padded out, so we can overrun the end. */
+  for ( uint16_t l_index = 0; l_index < count; l_index += 4 )
+  {
+    lane_store( &x[l_index], lane_add( lane_load( &x[l_index] ), lane_load( &vx[l_index] ) ) );
+    lane_store( &y[l_index], lane_add( lane_load( &y[l_index] ), lane_load( &vy[l_index] ) ) );
+  }
+#else
+  for ( uint16_t l_index = 0; l_index < count; l_index++ )
+  {
+    x[l_index] += vx[l_index];
+    y[l_index] += vy[l_index];
+  }
+#endif
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * snapshot - remembers where every ball is at the start of a tick, so that
+ *            they can be drawn part way between ticks.
+ */
+
+void BallSwarm::snapshot( void )
+{
+  memcpy( last_x, x, sizeof( x[0] ) * count );
+  memcpy( last_y, y, sizeof( y[0] ) * count );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * check_edges - flags up every ball that's touching an edge of the field, or
+ *               is somewhere it could hit a brick or the bat; most balls, most
+ *               of the time, won't be flagged and need no more attention.
+ *
+ * const swarm_limits_t & - the lines to check the balls against
+ */
+
+void BallSwarm::check_edges( const swarm_limits_t &p_limits )
+{
+#if defined( SWARM_SSE2 ) || defined( SWARM_NEON )
+  swarm_lane_t l_zero = lane_splat( sim_num_t( 0 ) );
+  swarm_lane_t l_left = lane_splat( p_limits.left );
+  swarm_lane_t l_right = lane_splat( p_limits.right );
+  swarm_lane_t l_top = lane_splat( p_limits.top );
+  swarm_lane_t l_bricks = lane_splat( p_limits.bricks );
+  swarm_lane_t l_bat = lane_splat( p_limits.bat );
+  swarm_lane_t l_lost = lane_splat( p_limits.lost );
+
+  for ( uint16_t l_index = 0; l_index < count; l_index += 4 )
+  {
+    swarm_lane_t l_x = lane_load( &x[l_index] );
+    swarm_lane_t l_y = lane_load( &y[l_index] );
+    swarm_lane_t l_vx = lane_load( &vx[l_index] );
+    swarm_mask_t l_flags;
+
+    /* The sides only count if the ball is heading towards them. */
+    l_flags = mask_flag( mask_and( lane_le( l_x, l_left ), lane_lt( l_vx, l_zero ) ), SWARM_FLAG_LEFT );
+    l_flags = mask_or( l_flags, mask_flag( mask_and( lane_le( l_right, l_x ), lane_lt( l_zero, l_vx ) ), SWARM_FLAG_RIGHT ) );
+    l_flags = mask_or( l_flags, mask_flag( lane_le( l_y, l_top ), SWARM_FLAG_TOP ) );
+    l_flags = mask_or( l_flags, mask_flag( lane_lt( l_y, l_bricks ), SWARM_FLAG_BRICKS ) );
+    l_flags = mask_or( l_flags, mask_flag( lane_le( l_bat, l_y ), SWARM_FLAG_BAT ) );
+    l_flags = mask_or( l_flags, mask_flag( lane_lt( l_lost, l_y ), SWARM_FLAG_LOST ) );
+    mask_store_flags( &flags[l_index], l_flags );
+  }
+#else
+  for ( uint16_t l_index = 0; l_index < count; l_index++ )
+  {
+    uint8_t l_flags = 0;
+
+    /* The sides only count if the ball is heading towards them. */
+    if ( x[l_index] <= p_limits.left && vx[l_index] < sim_num_t( 0 ) )
+    {
+      l_flags |= SWARM_FLAG_LEFT;
+    }
+    if ( p_limits.right <= x[l_index] && sim_num_t( 0 ) < vx[l_index] )
+    {
+      l_flags |= SWARM_FLAG_RIGHT;
+    }
+    if ( y[l_index] <= p_limits.top )
+    {
+      l_flags |= SWARM_FLAG_TOP;
+    }
+    if ( y[l_index] < p_limits.bricks )
+    {
+      l_flags |= SWARM_FLAG_BRICKS;
+    }
+    if ( p_limits.bat <= y[l_index] )
+    {
+      l_flags |= SWARM_FLAG_BAT;
+    }
+    if ( p_limits.lost < y[l_index] )
+    {
+      l_flags |= SWARM_FLAG_LOST;
+    }
+    flags[l_index] = l_flags;
+  }
+#endif
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * bounce - bounces a ball off a horizontal or vertical surface, just as a
+ *          normal ball would.
+ *
+ * uint16_t - the index of the ball
+ * bool     - a flag to indicate a horizontal (true) or vertical (false) bounce
+ */
+
+void BallSwarm::bounce( uint16_t p_index, bool p_horizontal )
+{
+  set_direction( p_index, Ball::bounce_direction( direction[p_index], p_horizontal ) );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_direction - points a ball in a new direction, at the swarm's speed.
+ *
+ * uint16_t - the index of the ball
+ * int32_t  - the new direction, in steps; any number of turns is fine.
+ */
+
+void BallSwarm::set_direction( uint16_t p_index, int32_t p_direction )
+{
+  direction[p_index] = p_direction & SIM_DIRECTION_MASK;
+  sim_vec_t l_vector = sim_direction<sim_num_t>( direction[p_index] ) * speed;
+  vx[p_index] = l_vector.x;
+  vy[p_index] = l_vector.y;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * offset - adds a (signed) offset to the location of a ball.
+ *
+ * uint16_t  - the index of the ball
+ * sim_vec_t - the offset to apply
+ */
+
+void BallSwarm::offset( uint16_t p_index, sim_vec_t p_offset )
+{
+  x[p_index] += p_offset.x;
+  y[p_index] += p_offset.y;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * accessors - for the GameSim to work with, and the GameState to draw.
+ */
+
+uint16_t BallSwarm::get_count( void )
+{
+  return count;
+}
+uint8_t BallSwarm::get_flags( uint16_t p_index )
+{
+  return flags[p_index];
+}
+sim_vec_t BallSwarm::get_location( uint16_t p_index )
+{
+  return sim_vec_t( x[p_index], y[p_index] );
+}
+sim_vec_t BallSwarm::get_vector( uint16_t p_index )
+{
+  return sim_vec_t( vx[p_index], vy[p_index] );
+}
+uint16_t BallSwarm::get_direction( uint16_t p_index )
+{
+  return direction[p_index];
+}
+blit::Point BallSwarm::get_render_location( uint16_t p_index, sim_num_t p_fraction )
+{
+  sim_vec_t l_last( last_x[p_index], last_y[p_index] );
+  sim_vec_t l_location = l_last + ( get_location( p_index ) - l_last ) * p_fraction;
+
+  /* Just as for a normal ball; half a sprite up and left of the centre. */
+  return ( l_location - sim_vec_t( 4, 4 ) ).to_point();
+}
+
+
+/*
+ * hash - folds the state of the swarm into a running hash.
+ *
+ * uint32_t - the hash so far
+ */
+
+uint32_t BallSwarm::hash( uint32_t p_hash )
+{
+  p_hash = hash_fnv1a( p_hash, &count, sizeof( count ) );
+  p_hash = hash_fnv1a( p_hash, x, sizeof( x[0] ) * count );
+  p_hash = hash_fnv1a( p_hash, y, sizeof( y[0] ) * count );
+  p_hash = hash_fnv1a( p_hash, vx, sizeof( vx[0] ) * count );
+  p_hash = hash_fnv1a( p_hash, vy, sizeof( vy[0] ) * count );
+  p_hash = hash_fnv1a( p_hash, direction, sizeof( direction[0] ) * count );
+  return p_hash;
+}
+
+
+/* End of BallSwarm.cpp */
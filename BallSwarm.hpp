@@ -0,0 +1,93 @@
+/*
+ * BallSwarm.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The BallSwarm holds the hundreds of small balls let loose by a mega
+ * multiball. Rather than being objects in their own right, they're kept as
+ * a set of arrays - positions, vectors and directions - so that moving them
+ * and checking them against the edges of the field can be done a handful at
+ * a time, with SIMD where there is some. Anything flagged by those checks is
+ * then dealt with one ball at a time, by the GameSim.
+ */
+
+#ifndef   _BALLSWARM_HPP_
+#define   _BALLSWARM_HPP_
+
+#include "Ball.hpp"
+
+
+/* How big a swarm we have room for; the PicoSystem is short of memory, so */
+/* it gets a smaller one. How many balls a game actually lets loose is up   */
+/* to the target it's played for (see GameSim). The capacity is kept to a   */
+/* multiple of four, as that's how they're processed.                       */
+#ifdef    PICO_BUILD
+#define SWARM_MAX_BALLS     128
+#else
+#define SWARM_MAX_BALLS     512
+#endif /* PICO_BUILD */
+
+/* Swarm balls are all small; this is the distance from their centre to the */
+/* edges of their bounding box (see BallT::get_extent).                     */
+#define SWARM_EXTENT        2
+
+/* The flags raised for each ball by the edge checks. */
+#define SWARM_FLAG_LEFT     0x01
+#define SWARM_FLAG_RIGHT    0x02
+#define SWARM_FLAG_TOP      0x04
+#define SWARM_FLAG_BRICKS   0x08
+#define SWARM_FLAG_BAT      0x10
+#define SWARM_FLAG_LOST     0x20
+
+/* The lines the edge checks test the centre of each ball against; they've */
+/* already been moved in by the extent of a ball, where that matters.      */
+typedef struct
+{
+  sim_num_t           left;
+  sim_num_t           right;
+  sim_num_t           top;
+  sim_num_t           bricks;
+  sim_num_t           bat;
+  sim_num_t           lost;
+} swarm_limits_t;
+
+
+class BallSwarm
+{
+private:
+  alignas( 16 ) sim_num_t x[SWARM_MAX_BALLS];
+  alignas( 16 ) sim_num_t y[SWARM_MAX_BALLS];
+  alignas( 16 ) sim_num_t vx[SWARM_MAX_BALLS];
+  alignas( 16 ) sim_num_t vy[SWARM_MAX_BALLS];
+  sim_num_t               last_x[SWARM_MAX_BALLS];
+  sim_num_t               last_y[SWARM_MAX_BALLS];
+  uint16_t                direction[SWARM_MAX_BALLS];
+  uint8_t                 flags[SWARM_MAX_BALLS];
+  uint16_t                count;
+  sim_num_t               speed;
+
+public:
+                          BallSwarm( void );
+  void                    clear( sim_num_t );
+  bool                    add( sim_vec_t, uint16_t );
+  void                    remove( uint16_t );
+  void                    integrate( void );
+  void                    snapshot( void );
+  void                    check_edges( const swarm_limits_t & );
+  void                    bounce( uint16_t, bool );
+  void                    set_direction( uint16_t, int32_t );
+  void                    offset( uint16_t, sim_vec_t );
+  uint16_t                get_count( void );
+  uint8_t                 get_flags( uint16_t );
+  sim_vec_t               get_location( uint16_t );
+  sim_vec_t               get_vector( uint16_t );
+  uint16_t                get_direction( uint16_t );
+  blit::Point             get_render_location( uint16_t, sim_num_t = sim_num_t( 1 ) );
+  uint32_t                hash( uint32_t );
+};
+
+#endif /* _BALLSWARM_HPP_ */
+
+/* End of BallSwarm.hpp */
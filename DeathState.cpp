@@ -18,7 +18,6 @@
 
 #include "32blit.hpp"
 #include "32blox.hpp"
-#include "assets_images.hpp"
 
 #include "DeathState.hpp"
 #include "GameState.hpp"
@@ -56,6 +55,9 @@ void DeathState::init( GameStateInterface *p_previous )
   /* Set the font tween running. */
   font_tween.start();
 
+  /* The widgets are added once we know there's a score to show. */
+  panel.init( BACKDROP_DEATH );
+
   /* The previous state *should* have been a GameState. */
   GameState *l_game = (GameState *)( p_previous );
 //  GameState *l_game = dynamic_cast<GameState *>( p_previous );
@@ -76,6 +78,58 @@ void DeathState::init( GameStateInterface *p_previous )
   /* Set the cursor to the beginning of the name. */
   cursor = 0;
 
+  /* Lay out the screen; first, show what the score was. */
+  char l_buffer[16];
+  snprintf( l_buffer, 12, "%05d", score );
+  score_label.init(
+    assets.message_font,
+    blit::Point( blit::screen.bounds.w / 2, 55 ),
+    blit::TextAlign::top_center
+  );
+  score_label.set_text( l_buffer );
+  score_label.set_pen( blit::Pen( 255, 255, 0 ) );
+  panel.add( &score_label );
+
+  /* And the name, ready for them to change if they want to... */
+  name_field.init(
+    assets.message_font,
+    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h / 2 )
+  );
+  panel.add( &name_field );
+
+  /* The static messaging next - congrats, and how to enter your name... */
+  congrats_label.init(
+    assets.message_font,
+    blit::Point( blit::screen.bounds.w / 2, 10 ),
+    blit::TextAlign::top_center
+  );
+  congrats_label.set_text( assets.get_text( STR_NEW_HIGH_SCORE ) );
+  panel.add( &congrats_label );
+  select_label.init(
+    assets.number_font,
+    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 55 ),
+    blit::TextAlign::bottom_center
+  );
+  select_label.set_text( assets.get_text( STR_LEFT_RIGHT_SELECT ) );
+  panel.add( &select_label );
+  change_label.init(
+    assets.number_font,
+    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 40 ),
+    blit::TextAlign::bottom_center
+  );
+  change_label.set_text( assets.get_text( STR_UP_DOWN_CHANGE ) );
+  panel.add( &change_label );
+
+  /* Lastly, prompt the user to press a button. */
+  save_label.init(
+    assets.message_font,
+    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 10 ),
+    blit::TextAlign::bottom_center
+  );
+  save_label.set_text( assets.get_text( STR_B_TO_SAVE ) );
+  panel.add( &save_label );
+  update_widgets();
+
   /* All done. */
   return;
 }
@@ -92,6 +146,9 @@ void DeathState::fini( GameStateInterface *p_next )
   /* Turn off the tweens. */
   font_tween.stop();
 
+  /* And let go of the backdrop, until it's needed again. */
+  backdrop.release();
+
   /* All done. */
   return;
 }
@@ -138,6 +195,9 @@ gamestate_t DeathState::update( uint32_t p_time )
     name[cursor]--;
   }
 
+  /* Bring the widgets up to date; they'll work out if anything's changed. */
+  update_widgets();
+
   /* If the user presses the save button, then we save their score and move on. */
   if ( blit::buttons.pressed & blit::Button::B )
   {
@@ -151,98 +211,49 @@ gamestate_t DeathState::update( uint32_t p_time )
 
 
 /*
- * render - called every frame (~20ms) to render the screen.
- * 
- * uint32_t - the elapsed time (in ms) since the game launched.
+ * update_widgets - brings the name entry up to date with the cursor and the
+ *                  pulsing pen, which the messages are drawn in too.
  */
 
-void DeathState::render( uint32_t p_time )
+void DeathState::update_widgets( void )
 {
-  char l_buffer[16];
-
-  /* Clear the screen down. */
-  blit::screen.clear();
-
-  /* Draw a smooth gradient backdrop. */
-  for ( uint16_t i = 0; i < blit::screen.bounds.h; i++ )
-  {
-    blit::screen.pen = blit::Pen( ( ( blit::screen.bounds.h - i ) / 2 ), 10, 10 );
-    blit::screen.h_span( blit::Point( 0, i ), blit::screen.bounds.w );
-  }
+  name_field.set_text( name );
+  name_field.set_cursor( cursor );
+  name_field.set_pens( blit::Pen( 255, 255, 255 ), font_pen );
+  congrats_label.set_pen( font_pen );
+  select_label.set_pen( font_pen );
+  change_label.set_pen( font_pen );
+  save_label.set_pen( font_pen );
 
-  /* Show what the score was. */
-  blit::screen.pen = blit::Pen( 255, 255, 0 );
-  snprintf( l_buffer, 12, "%05d", score );
-  blit::screen.text(
-    l_buffer,
-    assets.message_font,
-    blit::Point( blit::screen.bounds.w / 2, 55 ),
-    true,
-    blit::TextAlign::top_center
-  );
+  /* All done. */
+  return;
+}
 
-  /* And the name, ready for them to change if they want to... */
-  blit::screen.pen = blit::Pen( 255, 255, 255 );
-  snprintf( l_buffer, 12, "%c %c %c %c %c %c", 
-            name[0], name[1], name[2], name[3], name[4], name[5] );
-  blit::Size l_name_sz = blit::screen.measure_text( l_buffer, assets.message_font, true );
-  blit::Point l_name_box = blit::Point( 
-    ( blit::screen.bounds.w - l_name_sz.w ) / 2, 
-    ( blit::screen.bounds.h - l_name_sz.h ) / 2
-  );
 
-  blit::screen.text(
-    l_buffer,
-    assets.message_font,
-    l_name_box,
-    true,
-    blit::TextAlign::top_left
-  );
+/*
+ * invalidate - something else has drawn over the screen, so the panel will
+ *              need drawing again from scratch.
+ */
 
-  /* The rest is all in a nicely tweened pen. */
-  blit::screen.pen = font_pen;
+void DeathState::invalidate( void )
+{
+  panel.invalidate();
 
-  /* Draw a box around the current letter being edited. */
-  blit::Point l_char_box = l_name_box;
-  l_char_box.x += cursor * 32 - 5;
-  l_char_box.y -= 9;
-  blit::screen.h_span( l_char_box, 24 );
-  blit::screen.h_span( l_char_box + blit::Point( 0, 32 ), 24 );
-  blit::screen.v_span( l_char_box, 32 );
-  blit::screen.v_span( l_char_box + blit::Point( 23, 0 ), 32 );
+  /* All done. */
+  return;
+}
 
-  /* The static messaging next - congrats, and how to enter your name... */
-  blit::screen.text(
-    assets.get_text( STR_NEW_HIGH_SCORE ),
-    assets.message_font,
-    blit::Point( blit::screen.bounds.w / 2, 10 ),
-    true,
-    blit::TextAlign::top_center
-  );
-  blit::screen.text(
-    assets.get_text( STR_LEFT_RIGHT_SELECT ),
-    assets.number_font,
-    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 55 ),
-    true,
-    blit::TextAlign::bottom_center
-  );
-  blit::screen.text(
-    assets.get_text( STR_UP_DOWN_CHANGE ),
-    assets.number_font,
-    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 40 ),
-    true,
-    blit::TextAlign::bottom_center
-  );
 
-  /* Lastly, prompt the user to press a button. */
-  blit::screen.text(
-    assets.get_text( STR_B_TO_SAVE ),
-    assets.message_font,
-    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 10 ),
-    true,
-    blit::TextAlign::bottom_center
-  );
+/*
+ * render - called every frame (~20ms) to render the screen; the backdrop
+ *          doesn't move, so only the widgets that change are redrawn.
+ * 
+ * uint32_t - the elapsed time (in ms) since the game launched.
+ */
 
+void DeathState::render( uint32_t p_time )
+{
+  panel.render();
 
   /* All done. */
   return;
@@ -13,18 +13,30 @@
 #define   _DEATHSTATE_HPP_
 
 #include "AssetFactory.hpp"
+#include "Backdrop.hpp"
 #include "HighScore.hpp"
+#include "UI.hpp"
 
 class DeathState : public GameStateInterface
 {
 private:
   AssetFactory   &assets = AssetFactory::get_instance();
+  Backdrop       &backdrop = Backdrop::get_instance();
   char            name[7];
   uint16_t        score;
   uint8_t         cursor;  
   HighScore      *high_score;
   blit::Pen       font_pen;
   blit::Tween     font_tween;
+  UIPanel         panel;
+  UILabel         score_label;
+  UITextField     name_field;
+  UILabel         congrats_label;
+  UILabel         select_label;
+  UILabel         change_label;
+  UILabel         save_label;
+
+  void            update_widgets( void );
 
 public:
                   DeathState( void );
@@ -32,6 +44,7 @@ public:
   void            fini( GameStateInterface * );
   gamestate_t     update( uint32_t );
   void            render( uint32_t );
+  void            invalidate( void );
 };
 
 #endif /* _DEATHSTATE_HPP_ */
@@ -0,0 +1,208 @@
+/*
+ * DirtyRects.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * DirtyRects keeps track of the parts of the screen that need redrawing; a
+ * short list of rectangles, merged together wherever they overlap so that no
+ * pixel is ever in more than one of them. If it gets too fragmented to keep
+ * track of, it just gives up and covers the whole screen.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "DirtyRects.hpp"
+
+
+/* Functions. */
+
+/*
+ * overlaps - a stricter test than Rect::intersects, which counts rectangles
+ *            that merely touch; merging those would just waste fill.
+ */
+
+static bool overlaps( const blit::Rect &p_first, const blit::Rect &p_second )
+{
+  return ( p_first.x < p_second.x + p_second.w ) && ( p_second.x < p_first.x + p_first.w ) &&
+         ( p_first.y < p_second.y + p_second.h ) && ( p_second.y < p_first.y + p_first.h );
+}
+
+
+/*
+ * constructor - starts off clean, with no bounds at all.
+ */
+
+DirtyRects::DirtyRects( void )
+{
+  bounds = blit::Rect( 0, 0, 0, 0 );
+  count = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_bounds - sets the size of the surface being tracked; everything added
+ *              is clipped to it.
+ *
+ * blit::Size - the size of the surface
+ */
+
+void DirtyRects::set_bounds( blit::Size p_size )
+{
+  bounds = blit::Rect( blit::Point( 0, 0 ), p_size );
+  count = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * clear - forgets everything; nothing is dirty any more.
+ */
+
+void DirtyRects::clear( void )
+{
+  count = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * add - marks a rectangle as dirty; anything it overlaps is merged in with
+ *       it, which may in turn overlap something else, so we keep going
+ *       until it's clear of everything.
+ *
+ * blit::Rect - the rectangle to add
+ */
+
+void DirtyRects::add( blit::Rect p_rect )
+{
+  /* Nothing outside the surface is of any interest. */
+  blit::Rect l_rect = p_rect.intersection( bounds );
+  if ( l_rect.empty() )
+  {
+    return;
+  }
+
+  /* Swallow up anything it overlaps, starting again each time it grows. */
+  uint8_t l_index = 0;
+  while( l_index < count )
+  {
+    if ( overlaps( l_rect, rects[l_index] ) )
+    {
+      int32_t l_left = std::min( l_rect.x, rects[l_index].x );
+      int32_t l_top = std::min( l_rect.y, rects[l_index].y );
+      int32_t l_right = std::max( l_rect.x + l_rect.w, rects[l_index].x + rects[l_index].w );
+      int32_t l_bottom = std::max( l_rect.y + l_rect.h, rects[l_index].y + rects[l_index].h );
+      l_rect = blit::Rect( l_left, l_top, l_right - l_left, l_bottom - l_top );
+
+      rects[l_index] = rects[--count];
+      l_index = 0;
+      continue;
+    }
+    l_index++;
+  }
+
+  /* If there's no room left for it, the whole surface is dirty. */
+  if ( count >= DIRTY_MAX_RECTS )
+  {
+    add_all();
+    return;
+  }
+  rects[count++] = l_rect;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * add - marks everything dirty in another set as dirty in this one, too.
+ *
+ * const DirtyRects & - the other set of rectangles
+ */
+
+void DirtyRects::add( const DirtyRects &p_other )
+{
+  for ( uint8_t l_index = 0; l_index < p_other.count; l_index++ )
+  {
+    add( p_other.rects[l_index] );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * add_all - marks the whole surface as dirty.
+ */
+
+void DirtyRects::add_all( void )
+{
+  rects[0] = bounds;
+  count = 1;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * intersects - checks if any part of a rectangle is dirty.
+ *
+ * blit::Rect - the rectangle to check
+ *
+ * Returns true if it overlaps any of the dirty rectangles.
+ */
+
+bool DirtyRects::intersects( blit::Rect p_rect )
+{
+  for ( uint8_t l_index = 0; l_index < count; l_index++ )
+  {
+    if ( overlaps( p_rect, rects[l_index] ) )
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+/*
+ * get_count / get_rect - expose the dirty rectangles, for redrawing.
+ */
+
+uint8_t DirtyRects::get_count( void )
+{
+  return count;
+}
+blit::Rect DirtyRects::get_rect( uint8_t p_index )
+{
+  /* Sanity check the index. */
+  if ( p_index >= count )
+  {
+    return blit::Rect( 0, 0, 0, 0 );
+  }
+
+  return rects[p_index];
+}
+
+
+/* End of DirtyRects.cpp */
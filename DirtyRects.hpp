@@ -0,0 +1,40 @@
+/*
+ * DirtyRects.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * DirtyRects keeps track of the parts of the screen that need redrawing; a
+ * short list of rectangles, merged together wherever they overlap so that no
+ * pixel is ever in more than one of them. If it gets too fragmented to keep
+ * track of, it just gives up and covers the whole screen.
+ */
+
+#ifndef   _DIRTYRECTS_HPP_
+#define   _DIRTYRECTS_HPP_
+
+#define DIRTY_MAX_RECTS 32
+
+class DirtyRects
+{
+private:
+  blit::Rect        bounds;
+  blit::Rect        rects[DIRTY_MAX_RECTS];
+  uint8_t           count;
+
+public:
+                    DirtyRects( void );
+  void              set_bounds( blit::Size );
+  void              clear( void );
+  void              add( blit::Rect );
+  void              add( const DirtyRects & );
+  void              add_all( void );
+  bool              intersects( blit::Rect );
+  uint8_t           get_count( void );
+  blit::Rect        get_rect( uint8_t );
+};
+
+#endif /* _DIRTYRECTS_HPP_ */
+
+/* End of DirtyRects.hpp */
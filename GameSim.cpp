@@ -0,0 +1,1353 @@
+/*
+ * GameSim.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The GameSim holds the rules of the game; it moves the bat, the balls and
+ * the powerups, and keeps the score. It deliberately never touches the screen,
+ * the buttons or the blit runtime, so that it can be run headless at whatever
+ * speed the host can manage.
+ */
+
+/* System headers. */
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "GameSim.hpp"
+
+
+/* Module variables. */
+
+/* The limits in play on each target; the PicoSystem has less room, so it */
+/* gets fewer of everything, and its mega multiball is a smaller one.     */
+static const sim_limits_t m_limits[TARGET_MAX] =
+{
+  { 64, 32, 512, 32 },    /* TARGET_32BLIT */
+  { 32, 16, 128, 16 },    /* TARGET_PICOSYSTEM */
+  { 64, 32, 512, 32 }     /* TARGET_SDL */
+};
+
+
+/* Functions. */
+
+/*
+ * hash_fnv1a - folds a block of memory into a running FNV-1a hash; cheap, and
+ *              good enough to tell two game states apart.
+ *
+ * uint32_t     - the hash so far (start with HASH_SEED)
+ * const void * - the data to fold in
+ * uint32_t     - the length of the data, in bytes
+ */
+
+uint32_t hash_fnv1a( uint32_t p_hash, const void *p_data, uint32_t p_length )
+{
+  const uint8_t *l_data = (const uint8_t *)p_data;
+
+  for ( uint32_t l_index = 0; l_index < p_length; l_index++ )
+  {
+    p_hash ^= l_data[l_index];
+    p_hash *= 16777619u;
+  }
+
+  return p_hash;
+}
+
+
+/*
+ * constructor - create a simulation for a playing field of the given size.
+ *
+ * blit::Size    - the dimensions of the playing field (normally, the screen)
+ * target_type_t - the platform we're simulating, which decides the level set
+ */
+
+GameSim::GameSim( blit::Size p_bounds, target_type_t p_target )
+{
+  /* Save the field details. */
+  bounds = p_bounds;
+  target = p_target;
+  limits = &m_limits[target];
+
+  /* The bat height will always be the same, but is bound by the field size. */
+  bat_height = bounds.h - 10;
+
+  /* Nothing is loaded until we're reset; the level is just empty. */
+  lives = 0;
+  score = 0;
+  rng_state = 1;
+  event_count = 0;
+  collision_count = 0;
+  resolved_count = 0;
+  mega_multiball = false;
+  substeps = 1;
+  level_source = nullptr;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * reset - starts a whole new game, from the first level.
+ *
+ * uint32_t - the seed for the random number generator; the same seed and the
+ *            same inputs will always produce the same game.
+ */
+
+void GameSim::reset( uint32_t p_seed )
+{
+  /* Seed the generator; xorshift can't handle zero, so avoid it. */
+  rng_state = ( p_seed == 0 ) ? 0x32b10c5 : p_seed;
+
+  /* Reset the lives count and score. */
+  lives = 3;
+  score = 0;
+
+  /* Anything left over from the last game is of no interest now. */
+  clear_collisions();
+
+  /* And load the first level. */
+  load_level( 1 );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * random - returns the next number from our own random number generator. We
+ *          keep this to ourselves so that a game can be replayed exactly.
+ */
+
+uint32_t GameSim::random( void )
+{
+  /* A plain xorshift32; cheap, and identical on every platform. */
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+
+  return rng_state;
+}
+
+
+/*
+ * get_hash - works out a hash of the entire state of the simulation; if two
+ *            runs ever produce different hashes, they've diverged.
+ */
+
+uint32_t GameSim::get_hash( void )
+{
+  uint32_t l_hash = HASH_SEED;
+
+  /* Start with our own state. */
+  l_hash = hash_fnv1a( l_hash, &rng_state, sizeof( rng_state ) );
+  l_hash = hash_fnv1a( l_hash, &lives, sizeof( lives ) );
+  l_hash = hash_fnv1a( l_hash, &score, sizeof( score ) );
+  l_hash = hash_fnv1a( l_hash, &bat_position, sizeof( bat_position ) );
+  l_hash = hash_fnv1a( l_hash, &bat_speed, sizeof( bat_speed ) );
+  l_hash = hash_fnv1a( l_hash, &bat_type, sizeof( bat_type ) );
+
+  /* And then everything we're looking after. */
+  l_hash = level.hash( l_hash );
+  for ( auto l_ball : balls )
+  {
+    l_hash = l_ball->hash( l_hash );
+  }
+  for ( auto l_powerup : powerups )
+  {
+    l_hash = l_powerup->hash( l_hash );
+  }
+  if ( mega_multiball )
+  {
+    l_hash = swarm.hash( l_hash );
+  }
+
+  return l_hash;
+}
+
+
+/*
+ * add_event - records something that's happened this tick.
+ *
+ * sim_event_type_t - the type of event
+ * uint16_t         - any value associated with it
+ */
+
+void GameSim::add_event( sim_event_type_t p_type, uint16_t p_value )
+{
+  /* If we've run out of space, the event is simply lost. */
+  if ( event_count >= SIM_MAX_EVENTS )
+  {
+    return;
+  }
+
+  events[event_count].type = p_type;
+  events[event_count].value = p_value;
+  event_count++;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * move_bat - updates the bat position, taking into account the bat size and
+ *            the edges of the screen.
+ * sim_num_t - the movement wanted; this may get clipped if the edge is hit
+ */
+
+void GameSim::move_bat( sim_num_t p_movement )
+{
+  /* First up, let's apply the full movement. */
+  sim_num_t l_last_pos = bat_position;
+  bat_position += p_movement;
+
+  /* And then clamp it, left and right, honouring any level margins. */
+  if ( bat_position < sim_num_t( ( bat_width[bat_type] / 2 ) + level.get_margin() ) )
+  {
+    bat_position = sim_num_t( ( bat_width[bat_type] / 2 ) + level.get_margin() );
+  }
+  if ( bat_position > sim_num_t( bounds.w - ( bat_width[bat_type] / 2 ) - level.get_margin() ) )
+  {
+    bat_position = sim_num_t( bounds.w - ( bat_width[bat_type] / 2 ) - level.get_margin() );
+  }
+
+  /* Now, ask our balls to respond to the current bat. */
+  for ( auto l_ball : balls )
+  {
+    /* Then we can just ask the ball to move itself, if it wants to. */
+    l_ball->move_bat( bat_bounds(), bat_position - l_last_pos, bat_type == BAT_STICKY );
+  }
+
+  /* All done! */
+  return;
+}
+
+
+/*
+ * brick_to_screen - returns a Rect of the position of the designated brick,
+ *                   to make rendering and collision detection nice and consistent.
+ * uint8_t * 2 - the row and column in the brick being queried.
+ */
+
+blit::Rect GameSim::brick_to_screen( uint8_t p_row, uint8_t p_column )
+{
+  return blit::Rect(
+    ( p_column * BRICK_WIDTH ) + level.get_margin(), p_row * BRICK_HEIGHT + BRICK_TOP,
+    BRICK_WIDTH, BRICK_HEIGHT
+  );
+}
+
+
+/*
+ * screen_to_brick - returns the x/y co-ordinates of the brick at the given
+ *                   screen location.
+ * blit::Point - the screen location being queried.
+ */
+
+blit::Point GameSim::screen_to_brick( blit::Point p_location )
+{
+  /* Clamp the location to the field, in case a bounding box has slipped */
+  /* off somewhere, which can get ... messy.                             */
+  blit::Point l_location = blit::Rect( 0, 0, bounds.w, bounds.h ).clamp( p_location );
+
+  return blit::Point(
+    ( l_location.x - level.get_margin() ) / BRICK_WIDTH, ( l_location.y - BRICK_TOP ) / BRICK_HEIGHT
+  );
+}
+
+
+/*
+ * find_bricks - looks for bricks within a block of the grid, adding any that
+ *               are there to a contact; the block may stray outside the level,
+ *               in which case those cells are simply ignored.
+ *
+ * int16_t * 4     - the first and last column, then the first and last row
+ * sim_contact_t * - the contact to add any bricks to
+ *
+ * Returns true if any bricks were found.
+ */
+
+bool GameSim::find_bricks( int16_t p_first_column, int16_t p_last_column,
+                           int16_t p_first_row, int16_t p_last_row, sim_contact_t *p_contact )
+{
+  p_contact->brick_count = 0;
+
+  /* Clip the block to the level. */
+  if ( p_first_column < 0 )
+  {
+    p_first_column = 0;
+  }
+  if ( p_last_column >= level.get_width() )
+  {
+    p_last_column = level.get_width() - 1;
+  }
+  if ( p_first_row < 0 )
+  {
+    p_first_row = 0;
+  }
+  if ( p_last_row >= level.get_height() )
+  {
+    p_last_row = level.get_height() - 1;
+  }
+
+  /* Nothing to find if the block lies entirely outside the level. */
+  if ( p_first_column > p_last_column || p_first_row > p_last_row )
+  {
+    return false;
+  }
+
+  /* And gather up anything that's there, straight from the row masks. */
+  uint16_t l_span = ( 2u << p_last_column ) - ( 1u << p_first_column );
+  for ( int16_t l_row = p_first_row; l_row <= p_last_row; l_row++ )
+  {
+    uint16_t l_bits = level.get_row_mask( l_row ) & l_span;
+    while ( l_bits != 0 && p_contact->brick_count < SIM_MAX_CONTACT )
+    {
+      p_contact->bricks[p_contact->brick_count++] = blit::Point( count_trailing_zeros( l_bits ), l_row );
+      l_bits &= l_bits - 1;
+    }
+  }
+
+  return p_contact->brick_count > 0;
+}
+
+
+/*
+ * sweep_bricks - walks the ball's bounding box along its path for this tick,
+ *                through the brick grid one grid line at a time, and finds
+ *                the first point where its leading edge runs into a brick.
+ *                The cost depends on the number of grid lines crossed, not
+ *                the distance, so fast balls can't tunnel through bricks.
+ *
+ * sim_vec_t       - where the centre of the ball started
+ * sim_vec_t       - where the centre of the ball ended up
+ * sim_num_t       - the extent of the ball's bounding box from its centre
+ * sim_contact_t * - filled in with the details of the first contact, if any
+ *
+ * Returns true if the ball hit a brick along the way.
+ */
+
+bool GameSim::sweep_bricks( sim_vec_t p_from, sim_vec_t p_to, sim_num_t p_extent, sim_contact_t *p_contact )
+{
+  sim_vec_t   l_delta = p_to - p_from;
+  sim_num_t   l_margin = level.get_margin();
+  sim_num_t   l_never = 2;
+  int16_t     l_column = 0, l_row = 0;
+  int8_t      l_step_column = 0, l_step_row = 0;
+  sim_num_t   l_next_x = l_never, l_next_y = l_never;
+  sim_num_t   l_gap_x = 0, l_gap_y = 0;
+
+  /* Work out when the leading vertical edge crosses its first grid line, */
+  /* and which column that takes it into; a fraction over 1 means never.  */
+  if ( l_delta.x > sim_num_t( 0 ) )
+  {
+    sim_num_t l_edge = p_from.x + p_extent;
+    l_column = (int16_t)sim_floor( ( l_edge - l_margin ) / sim_num_t( BRICK_WIDTH ) ) + 1;
+    l_next_x = ( l_margin + sim_num_t( l_column * BRICK_WIDTH ) - l_edge ) / l_delta.x;
+    l_gap_x = sim_num_t( BRICK_WIDTH ) / l_delta.x;
+    l_step_column = 1;
+  }
+  else if ( l_delta.x < sim_num_t( 0 ) )
+  {
+    sim_num_t l_edge = p_from.x - p_extent;
+    l_column = (int16_t)sim_floor( ( l_edge - l_margin ) / sim_num_t( BRICK_WIDTH ) );
+    l_next_x = ( l_margin + sim_num_t( l_column * BRICK_WIDTH ) - l_edge ) / l_delta.x;
+    l_gap_x = sim_num_t( BRICK_WIDTH ) / -l_delta.x;
+    l_step_column = -1;
+    l_column--;
+  }
+
+  /* And the same for the leading horizontal edge, and the rows. */
+  if ( l_delta.y > sim_num_t( 0 ) )
+  {
+    sim_num_t l_edge = p_from.y + p_extent;
+    l_row = (int16_t)sim_floor( ( l_edge - sim_num_t( BRICK_TOP ) ) / sim_num_t( BRICK_HEIGHT ) ) + 1;
+    l_next_y = ( sim_num_t( BRICK_TOP + l_row * BRICK_HEIGHT ) - l_edge ) / l_delta.y;
+    l_gap_y = sim_num_t( BRICK_HEIGHT ) / l_delta.y;
+    l_step_row = 1;
+  }
+  else if ( l_delta.y < sim_num_t( 0 ) )
+  {
+    sim_num_t l_edge = p_from.y - p_extent;
+    l_row = (int16_t)sim_floor( ( l_edge - sim_num_t( BRICK_TOP ) ) / sim_num_t( BRICK_HEIGHT ) );
+    l_next_y = ( sim_num_t( BRICK_TOP + l_row * BRICK_HEIGHT ) - l_edge ) / l_delta.y;
+    l_gap_y = sim_num_t( BRICK_HEIGHT ) / -l_delta.y;
+    l_step_row = -1;
+    l_row--;
+  }
+
+  /* Any gap longer than the whole tick might as well be never; capping it */
+  /* keeps the sums below in range, whichever number type we're using.     */
+  if ( l_gap_x > l_never )
+  {
+    l_gap_x = l_never;
+  }
+  if ( l_gap_y > l_never )
+  {
+    l_gap_y = l_never;
+  }
+
+  /* Now step through the grid lines in the order the ball crosses them. */
+  while( l_next_x <= sim_num_t( 1 ) || l_next_y <= sim_num_t( 1 ) )
+  {
+    if ( l_next_x <= l_next_y )
+    {
+      /* Once we've left the level sideways, no more columns can be hit. */
+      if ( ( l_step_column > 0 && l_column >= level.get_width() ) || ( l_step_column < 0 && l_column < 0 ) )
+      {
+        l_next_x = l_never;
+        continue;
+      }
+
+      /* Into a new column; check the rows the leading edge spans there. */
+      sim_num_t l_y = p_from.y + l_delta.y * l_next_x;
+      if ( find_bricks( l_column, l_column,
+                        (int16_t)sim_floor( ( l_y - p_extent - sim_num_t( BRICK_TOP ) ) / sim_num_t( BRICK_HEIGHT ) ),
+                        (int16_t)sim_floor( ( l_y + p_extent - sim_num_t( BRICK_TOP ) ) / sim_num_t( BRICK_HEIGHT ) ),
+                        p_contact ) )
+      {
+        p_contact->fraction = l_next_x;
+        p_contact->horizontal = true;
+        return true;
+      }
+
+      l_column += l_step_column;
+      l_next_x += l_gap_x;
+    }
+    else
+    {
+      /* Once we've left the level vertically, no more rows can be hit. */
+      if ( ( l_step_row > 0 && l_row >= level.get_height() ) || ( l_step_row < 0 && l_row < 0 ) )
+      {
+        l_next_y = l_never;
+        continue;
+      }
+
+      /* Into a new row; check the columns the leading edge spans there. */
+      sim_num_t l_x = p_from.x + l_delta.x * l_next_y;
+      if ( find_bricks( (int16_t)sim_floor( ( l_x - p_extent - l_margin ) / sim_num_t( BRICK_WIDTH ) ),
+                        (int16_t)sim_floor( ( l_x + p_extent - l_margin ) / sim_num_t( BRICK_WIDTH ) ),
+                        l_row, l_row,
+                        p_contact ) )
+      {
+        p_contact->fraction = l_next_y;
+        p_contact->horizontal = false;
+        return true;
+      }
+
+      l_row += l_step_row;
+      l_next_y += l_gap_y;
+    }
+  }
+
+  /* Made it all the way without hitting anything. */
+  return false;
+}
+
+
+/*
+ * bat_bounds - returns a Rect defining the countaining bounds of the current
+ *              bat. This take into account the bat type, so dynimcally changes
+ *              if, for example, a powerup changes the bat.
+ */
+
+blit::Rect GameSim::bat_bounds( void )
+{
+  return blit::Rect(
+                     sim_to_int( bat_position - sim_num_t( bat_width[bat_type] / 2 ) ),
+                     bat_height,
+                     bat_width[bat_type],
+                     8
+                   );
+}
+
+
+/*
+ * bat_render_bounds - returns a Rect for drawing the bat; it's drawn part way
+ *                     between where it was at the last tick and where it is
+ *                     now, so that it moves smoothly between ticks.
+ *
+ * sim_num_t - how far through the current tick we are, from 0 to 1
+ */
+
+blit::Rect GameSim::bat_render_bounds( sim_num_t p_fraction )
+{
+  sim_num_t l_position = last_bat_position + ( bat_position - last_bat_position ) * p_fraction;
+
+  return blit::Rect(
+                     sim_to_int( l_position - sim_num_t( bat_width[bat_type] / 2 ) ),
+                     bat_height,
+                     bat_width[bat_type],
+                     8
+                   );
+}
+
+
+/*
+ * spawn_ball - creates a new ball; on the bat - either at the start of the
+ *              level, or after a ball is lost - when the flag is set, or at
+ *              the location of another ball in 'mid flight', when false.
+ */
+
+void GameSim::spawn_ball( bool pBat )
+{
+  Ball *l_ball;
+  blit::Point l_ballpos;
+
+  /* The random number is drawn whether or not the ball appears, so that */
+  /* running out of room can't throw the rest of the game off course.    */
+  uint32_t l_random = random();
+
+  /* If the pool is full, there's simply no room for another ball; and if */
+  /* it's empty, there's nowhere for a mid flight ball to come from.      */
+  if ( balls.full() || balls.size() >= limits->balls || ( !pBat && balls.empty() ) )
+  {
+    return;
+  }
+
+  /* Work out the right place for the ball to be. */
+  if ( pBat )
+  {
+    /* The ball starts in the middle of the bat. */
+    l_ballpos = blit::Point( sim_to_int( bat_position ), bat_height - 3 );
+
+    /* But then we offset it a little one side or the other... */
+    switch( l_random % 4 )
+    {
+      case 0:
+        l_ballpos.x -= 4;
+        break;
+      case 1:
+        l_ballpos.x -= 2;
+        break;
+      case 2:
+        l_ballpos.x += 2;
+        break;
+      case 3:
+        l_ballpos.x += 4;
+        break;
+    }
+
+    /* create a new ball. */
+    l_ball = balls.acquire( l_ballpos, bounds.w, step_speed( level.get_ball_speed() ) );
+
+    /* Stick it to the bat. */
+    l_ball->stuck = true;
+  }
+  else
+  {
+    /* Grab the location of the first ball in the queue. */
+    auto l_current_ball = balls.front();
+    l_ballpos = l_current_ball->get_bounds().center();
+
+    /* create a new ball. */
+    l_ball = balls.acquire( l_ballpos, bounds.w, step_speed( level.get_ball_speed() ) );
+    l_ball->randomise( l_random );
+  }
+
+  /* And let it know where the bat is. */
+  l_ball->move_bat( bat_bounds(), 0.0f, false );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * add_balls - spawns extra balls in mid flight, from wherever the first ball
+ *             currently is; this is what a multiball does.
+ *
+ * uint8_t - the number of balls to add.
+ */
+
+void GameSim::add_balls( uint8_t p_count )
+{
+  for ( uint8_t l_index = 0; l_index < p_count; l_index++ )
+  {
+    spawn_ball( false );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * add_swarm - lets loose a batch of swarm balls, from wherever the first ball
+ *             currently is, each heading off in a random direction; this is
+ *             what a mega multiball does.
+ *
+ * uint16_t - the number of balls to add.
+ */
+
+void GameSim::add_swarm( uint16_t p_count )
+{
+  sim_vec_t l_origin;
+
+  /* The balls come from the first ball we have, of either kind. */
+  if ( !balls.empty() )
+  {
+    l_origin = balls.front()->get_location();
+  }
+  else if ( swarm.get_count() > 0 )
+  {
+    l_origin = swarm.get_location( 0 );
+  }
+  else
+  {
+    return;
+  }
+
+  /* And off they go, until we run out of them or room for them. */
+  for ( uint16_t l_index = 0; l_index < p_count; l_index++ )
+  {
+    if ( swarm.get_count() >= limits->swarm || !swarm.add( l_origin, Ball::random_direction( random() ) ) )
+    {
+      break;
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_mega_multiball - switches mega multiball on or off; this is a rule of
+ *                      the game, so it should only be changed between games.
+ *
+ * bool - true to turn mega multiball on
+ */
+
+void GameSim::set_mega_multiball( bool p_enabled )
+{
+  mega_multiball = p_enabled;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_level_source - sets somewhere else to load levels from, instead of the
+ *                    built-in ones; nullptr goes back to the built-in levels.
+ *                    Like mega multiball, this is a rule of the game.
+ *
+ * LevelSource * - where to load levels from; it must outlive the game
+ */
+
+void GameSim::set_level_source( LevelSource *p_source )
+{
+  level_source = p_source;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_substeps - sets how many substeps each tick's physics is split into;
+ *                more steps means more resolution, at more cost. Like mega
+ *                multiball, this should only be changed between games.
+ *
+ * uint8_t - the number of substeps, from 1 to SIM_MAX_SUBSTEPS
+ */
+
+void GameSim::set_substeps( uint8_t p_substeps )
+{
+  if ( p_substeps < 1 )
+  {
+    p_substeps = 1;
+  }
+  if ( p_substeps > SIM_MAX_SUBSTEPS )
+  {
+    p_substeps = SIM_MAX_SUBSTEPS;
+  }
+  substeps = p_substeps;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * step_speed - scales a speed per tick down to a speed per substep.
+ *
+ * sim_num_t - the speed, in pixels per tick
+ */
+
+sim_num_t GameSim::step_speed( sim_num_t p_speed )
+{
+  return p_speed / sim_num_t( substeps );
+}
+
+
+/*
+ * load_level - loads the required level data, resets the balls, the bats and
+ *              everything else for the start of a whole new level
+ */
+
+void GameSim::load_level( uint16_t p_level )
+{
+  /* Load up the level data, into the level we already have; if there's a */
+  /* level source that can't provide it, fall back to the built-in one.   */
+  if ( level_source == nullptr || !level_source->load( p_level, level ) )
+  {
+    level.reset( p_level, target );
+  }
+
+  /* Centre the bat, and set it to a default type. */
+  bat_position = sim_num_t( bounds.w / 2 );
+  last_bat_position = bat_position;
+  bat_speed = sim_num_t( 1 );
+  bat_type = BAT_NORMAL;
+
+  /* Clear out the list of balls, and spawn one on the bat. */
+  balls.clear();
+  spawn_ball( true );
+
+  /* Clear out the list of powerups, and any swarm, too. */
+  powerups.clear();
+  swarm.clear( step_speed( level.get_ball_speed() ) );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * apply_powerup - applies the effects of a powerup that the bat has caught.
+ *
+ * powerup_type_t - the type of powerup collected.
+ */
+
+void GameSim::apply_powerup( powerup_type_t p_type )
+{
+  /* Apply the amazing power up. */
+  switch( p_type )
+  {
+  case POWERUP_SPEED:
+    bat_speed += sim_num_t( 0.8f );
+    break;
+  case POWERUP_SLOW:
+    bat_speed -= sim_num_t( 0.6f );
+    if ( bat_speed < sim_num_t( 0.5f ) )
+    {
+      bat_speed = sim_num_t( 0.5f );
+    }
+    break;
+  case POWERUP_STICKY:
+    bat_type = BAT_STICKY;
+    break;
+  case POWERUP_GROW:
+    if ( bat_type == BAT_NARROW )
+    {
+      bat_type = BAT_NORMAL;
+    }
+    else
+    {
+      bat_type = BAT_WIDE;
+    }
+    break;
+  case POWERUP_SHRINK:
+    if ( bat_type == BAT_WIDE )
+    {
+      bat_type = BAT_NORMAL;
+    }
+    else
+    {
+      bat_type = BAT_NARROW;
+    }
+    break;
+  case POWERUP_MULTI:
+    if ( mega_multiball )
+    {
+      add_swarm( limits->swarm_batch );
+    }
+    else
+    {
+      add_balls( 2 );
+    }
+    break;
+  case POWERUP_EXTRA:
+    lives++;
+    break;
+  }
+
+  /* Grant some points for it! */
+  score += 15;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * hit_bricks - hits every brick in a contact, and records the collision; the
+ *              bricks are damaged straight away, so that nothing else hits
+ *              them this step, but the scoring waits for resolve_collisions.
+ *
+ * const sim_contact_t & - the contact, from sweep_bricks
+ * sim_vec_t             - where the ball was, at the contact
+ * uint16_t              - which ball it was
+ */
+
+void GameSim::hit_bricks( const sim_contact_t &p_contact, sim_vec_t p_position, uint16_t p_ball )
+{
+  uint8_t     l_points = 0;
+  bool        l_destroyed = false;
+  blit::Point l_brick;
+
+  for ( uint8_t l_index = 0; l_index < p_contact.brick_count; l_index++ )
+  {
+    l_points += level.hit_brick( p_contact.bricks[l_index] );
+
+    /* Check to see if the brick was destroyed; only one gets to drop. */
+    if ( level.get_brick( p_contact.bricks[l_index] ) == 0 )
+    {
+      l_destroyed = true;
+      l_brick = p_contact.bricks[l_index];
+    }
+  }
+
+  add_collision( SIM_COLLISION_BRICK, p_position, p_ball, l_points, l_destroyed ? &l_brick : nullptr );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * drop_powerup - maybe drops a powerup from a brick that's been destroyed;
+ *                the odds get better as the levels go by.
+ *
+ * blit::Point - the location of the brick, in the grid
+ */
+
+void GameSim::drop_powerup( blit::Point p_brick )
+{
+  if ( ( random() % 10 ) <= ( level.get_level() / 3u ) )
+  {
+    /* Work out the screen location of the brick. */
+    blit::Rect l_brick = brick_to_screen( p_brick.y, p_brick.x );
+    powerup_type_t l_type = (powerup_type_t)( random() % POWERUP_MAX );
+    if ( powerups.size() < limits->powerups &&
+         powerups.acquire( l_brick.center(), l_type, bounds.h, step_speed( sim_num_t( 0.75f ) ) ) != nullptr )
+    {
+      add_event( SIM_EVENT_POWERUP_DROPPED, l_type );
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * update_swarm - moves the whole swarm on a tick, and deals with any of it
+ *                that's run into something. All the swarm is moved and checked
+ *                in bulk, and then only the flagged balls need looking at.
+ */
+
+void GameSim::update_swarm( void )
+{
+  swarm_limits_t l_limits;
+  sim_num_t      l_extent = SWARM_EXTENT;
+  blit::Rect     l_bat = bat_bounds();
+  sim_contact_t  l_contact;
+
+  /* Work out the lines that a ball's centre has to cross to be of interest. */
+  l_limits.left = sim_num_t( level.get_margin() ) + l_extent;
+  l_limits.right = sim_num_t( bounds.w - level.get_margin() ) - l_extent;
+  l_limits.top = l_extent;
+  l_limits.bricks = sim_num_t( BRICK_TOP + level.get_height() * BRICK_HEIGHT ) + l_extent;
+  l_limits.bat = sim_num_t( bat_height ) - l_extent;
+  l_limits.lost = sim_num_t( bounds.h ) + l_extent;
+
+  /* Move everything, and see what's where. */
+  swarm.integrate();
+  swarm.check_edges( l_limits );
+
+  /* Work backwards, so that removing a ball doesn't skip the next one. */
+  for ( uint16_t l_index = swarm.get_count(); l_index-- > 0; )
+  {
+    uint8_t l_flags = swarm.get_flags( l_index );
+
+    /* Most balls, most of the time, are just flying through empty space. */
+    if ( l_flags == 0 )
+    {
+      continue;
+    }
+
+    /* Anything that's dropped off the bottom is simply gone. */
+    if ( l_flags & SWARM_FLAG_LOST )
+    {
+      swarm.remove( l_index );
+      continue;
+    }
+
+    /* Remember where the ball came from this tick. */
+    sim_vec_t l_to = swarm.get_location( l_index );
+    sim_vec_t l_from = l_to - swarm.get_vector( l_index );
+
+    /* The top and sides of the screen; no points for the swarm, though. */
+    uint16_t l_ball = SIM_BALL_SWARM | l_index;
+    if ( ( l_flags & SWARM_FLAG_TOP ) && swarm.get_vector( l_index ).y < sim_num_t( 0 ) )
+    {
+      add_collision( SIM_COLLISION_BOUNDS, l_to, l_ball );
+      swarm.bounce( l_index, false );
+    }
+    if ( l_flags & ( SWARM_FLAG_LEFT | SWARM_FLAG_RIGHT ) )
+    {
+      add_collision( SIM_COLLISION_BOUNDS, l_to, l_ball );
+      swarm.bounce( l_index, true );
+    }
+
+    /* The bricks work just like they do for a normal ball. */
+    if ( ( l_flags & SWARM_FLAG_BRICKS ) && sweep_bricks( l_from, l_to, l_extent, &l_contact ) )
+    {
+      swarm.offset( l_index, ( l_to - l_from ) * ( l_contact.fraction - sim_num_t( 1 ) ) );
+      hit_bricks( l_contact, swarm.get_location( l_index ), l_ball );
+      swarm.bounce( l_index, l_contact.horizontal );
+    }
+
+    /* And the bat; the swarm never sticks to it, it just bounces off. */
+    if ( l_flags & SWARM_FLAG_BAT )
+    {
+      sim_vec_t l_location = swarm.get_location( l_index );
+      sim_vec_t l_vector = swarm.get_vector( l_index );
+
+      if ( ( l_vector.y > sim_num_t( 0 ) ) &&
+           ( l_location.x + l_extent > sim_num_t( l_bat.x ) ) &&
+           ( l_location.x - l_extent < sim_num_t( l_bat.x + l_bat.w ) ) &&
+           ( l_location.y + l_extent - l_vector.y < sim_num_t( bat_height ) ) )
+      {
+        swarm.set_direction( l_index, Ball::bounce_direction( swarm.get_direction( l_index ), false )
+                                      + Ball::bat_angle( l_location.x, l_bat ) );
+        add_collision( SIM_COLLISION_BAT, l_location, l_ball );
+      }
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * update - advances the simulation by a single tick.
+ *
+ * sim_input_t - the state of the controls for this tick.
+ */
+
+void GameSim::update( const sim_input_t &p_input )
+{
+  /* Start the tick with a clean slate of events. */
+  event_count = 0;
+
+  /* And remember where everything was, so it can be drawn between ticks. */
+  last_bat_position = bat_position;
+  for ( auto l_ball : balls )
+  {
+    l_ball->snapshot();
+  }
+  for ( auto l_powerup : powerups )
+  {
+    l_powerup->snapshot();
+  }
+  swarm.snapshot();
+
+  /* Calculate any bat movement that's required. */
+  sim_num_t l_movement = 0;
+  sim_num_t l_joystick = sim_num_t( p_input.joystick ) / sim_num_t( 127 );
+
+  /* Handle the joystick, which is slightly more gradiated. */
+  if ( l_joystick < sim_num_t( -0.66f ) )
+  {
+    l_movement = -bat_speed;
+  }
+  else if ( l_joystick > sim_num_t( 0.66f ) )
+  {
+    l_movement = bat_speed;
+  }
+  else
+  {
+    l_movement = bat_speed * sim_num_t( 1.5f ) * l_joystick;
+  }
+
+  /* But if the player has moved the dpad, then use that instead. */
+  if ( p_input.buttons & SIM_INPUT_LEFT )
+  {
+    l_movement = -bat_speed;
+  }
+  if ( p_input.buttons & SIM_INPUT_RIGHT )
+  {
+    l_movement = bat_speed;
+  }
+
+  /* And lastly, apply that movement. */
+  if ( l_movement != sim_num_t( 0 ) )
+  {
+    move_bat( l_movement );
+  }
+
+  /* Next, if the user presses B and there's a ball on the bat, fire it. */
+  /* And yes, if we've collected multiple balls, we launch them all!     */
+  if ( ( p_input.buttons & SIM_INPUT_LAUNCH ) && lives > 0 )
+  {
+    /* Work through all our balls then. */
+    for ( auto l_ball : balls )
+    {
+      /* Only interested in one that's stuck. */
+      if ( l_ball->stuck )
+      {
+        /* Balls know how to launch themselves, happily. */
+        l_ball->launch();
+
+        /* But only launch one... */
+        break;
+      }
+    }
+  }
+
+  /* And then run the physics, in as many steps as we've been asked for. */
+  for ( uint8_t l_step = 1; l_step <= substeps; l_step++ )
+  {
+    step( l_step == substeps );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * step - advances the physics by a single substep; everything moves at its
+ *        speed divided by the number of substeps, so the game plays at the
+ *        same pace however finely it's being worked out.
+ *
+ * bool - true if this is the last substep in the tick.
+ */
+
+void GameSim::step( bool p_last )
+{
+  /* Next up, we work our way through all the balls we have, and update their */
+  /* positions. We'll deal with any collisions in a little while...           */
+  for ( auto l_ball : balls )
+  {
+    uint16_t l_id = balls.index_of( l_ball );
+    sim_contact_t l_contact;
+
+    /* Remember where the ball started from, for the collision sweep. */
+    sim_vec_t l_from = l_ball->get_location();
+
+    /* Update the balls position. */
+    l_ball->update();
+
+    /* And fetch the bounds of the ball in it's new location. */
+    blit::Rect l_new_bounds = l_ball->get_bounds();
+
+    /* Collision detect on the top of the screen. */
+    if ( l_new_bounds.y <= 0 )
+    {
+      add_collision( SIM_COLLISION_BOUNDS, l_ball->get_location(), l_id );
+      l_ball->bounce( false );
+    }
+
+    /* And the edges of the screen, which gives some points too! */
+    if ( ( l_new_bounds.x <= level.get_margin() && l_ball->moving_left() )
+         ||
+         ( ( l_new_bounds.x + l_new_bounds.w ) >= ( bounds.w - level.get_margin() ) && !l_ball->moving_left() ) )
+    {
+      add_collision( SIM_COLLISION_BOUNDS, l_ball->get_location(), l_id, 1 );
+      l_ball->bounce( true );
+    }
+
+    /* Now sweep the ball's path through the brick grid, to find the first */
+    /* brick it ran into (if any), however far it travelled this tick.      */
+    sim_vec_t l_to = l_ball->get_location();
+    if ( sweep_bricks( l_from, l_to, l_ball->get_extent(), &l_contact ) )
+    {
+      /* Pull the ball back to the point of contact, and bounce it away. */
+      l_ball->offset( ( l_to - l_from ) * ( l_contact.fraction - sim_num_t( 1 ) ) );
+      l_new_bounds = l_ball->get_bounds();
+      l_ball->bounce( l_contact.horizontal );
+
+      /* And hit everything the leading edge touched. */
+      hit_bricks( l_contact, l_ball->get_location(), l_id );
+    }
+
+    /* And lastly, the bat itself. */
+    if ( ( sim_num_t( l_new_bounds.x ) < ( bat_position + sim_num_t( bat_width[bat_type] / 2 ) ) ) &&
+         ( sim_num_t( l_new_bounds.x + l_new_bounds.w ) > ( bat_position - sim_num_t( bat_width[bat_type] / 2 ) ) ) &&
+         ( ( l_new_bounds.y + l_new_bounds.h ) >= bat_height ) )
+    {
+      if ( l_ball->bat_bounce( bat_height, bat_type == BAT_STICKY ) )
+      {
+        add_collision( SIM_COLLISION_BAT, l_ball->get_location(), l_id );
+      }
+    }
+  }
+
+  /* Clean up any balls that drop off the bottom of the screen. */
+  int32_t l_height = bounds.h;
+  balls.remove_if( [l_height](auto l_ball) { return l_ball->get_bounds().y > l_height; } );
+
+  /* The swarm looks after itself, in bulk. */
+  if ( swarm.get_count() > 0 )
+  {
+    update_swarm();
+  }
+
+  /* Everything that got hit this step gets scored, and maybe drops a */
+  /* powerup, in the order it was hit.                                 */
+  resolve_collisions();
+
+  /* Work through all the powerups. */
+  for ( auto l_powerup : powerups )
+  {
+    /* Update the powerup position. */
+    l_powerup->update();
+    blit::Rect l_powerup_bounds = l_powerup->get_bounds();
+
+    /* Let the world know it's still falling, once a tick is plenty. */
+    if ( p_last )
+    {
+      add_event( SIM_EVENT_POWERUP_FALLING, l_powerup_bounds.center().y );
+    }
+
+    /* And then check to see if there's a collision with the bat. */
+    if ( l_powerup_bounds.intersects( bat_bounds() ) )
+    {
+      /* Apply the amazing power up. */
+      apply_powerup( l_powerup->get_type() );
+      add_event( SIM_EVENT_POWERUP_COLLECTED, l_powerup->get_type() );
+
+      /* And just drop the thing off the bottom of the screen; it'll get */
+      /* then get cleared up in a little while.                          */
+      l_powerup->remove();
+    }
+  }
+
+  /* And clean up any powerups that are off the screen too. */
+  powerups.remove_if( [l_height](auto l_powerup) { return l_powerup->get_bounds().y > l_height; } );
+
+  /* If there are no more balls in play, then we lose a life. */
+  if ( balls.empty() && swarm.get_count() == 0 )
+  {
+    /* Switch the bat back to standard type and speed, too. */
+    bat_speed = sim_num_t( 1 );
+    bat_type = BAT_NORMAL;
+
+    /* Reduce our lives, spawn a fresh ball if we can. */
+    lives--;
+    spawn_ball( true );
+    add_event( SIM_EVENT_BALL_LOST, lives );
+  }
+
+  /* Lastly, check the level - if we've cleared all the clearable bricks, */
+  /* then it's time to move onto the next one!                            */
+  if ( level.get_brick_count() == 0 )
+  {
+    load_level( level.get_level() + 1 );
+    add_event( SIM_EVENT_LEVEL_COMPLETE, level.get_level() );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * add_collision - records a ball running into something; it's not scored
+ *                 until the end of the step, by resolve_collisions.
+ *
+ * sim_collision_type_t - what the ball ran into
+ * sim_vec_t            - where the ball was, when it did
+ * uint16_t             - which ball it was (see SIM_BALL_SWARM)
+ * uint8_t              - the points it earns
+ * blit::Point *        - the brick it destroyed, if it did
+ */
+
+void GameSim::add_collision( sim_collision_type_t p_type, sim_vec_t p_position, uint16_t p_ball,
+                             uint8_t p_points, const blit::Point *p_destroyed )
+{
+  sim_collision_t l_collision;
+
+  l_collision.type = p_type;
+  l_collision.position = blit::Point( sim_to_int( p_position.x ), sim_to_int( p_position.y ) );
+  l_collision.brick = ( p_destroyed == nullptr ) ? blit::Point( 0, 0 ) : *p_destroyed;
+  l_collision.ball = p_ball;
+  l_collision.points = p_points;
+  l_collision.destroyed = ( p_destroyed != nullptr );
+
+  /* If there's no room left, the collision still has to count; settle all */
+  /* the ones waiting, in order, and then this one, without keeping it.    */
+  if ( collision_count >= SIM_MAX_COLLISIONS )
+  {
+    resolve_collisions();
+    resolve_collision( l_collision );
+    return;
+  }
+
+  collisions[collision_count++] = l_collision;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * resolve_collision - scores a single collision, and gives a destroyed brick
+ *                     the chance to drop a powerup.
+ *
+ * const sim_collision_t & - the collision to resolve
+ */
+
+void GameSim::resolve_collision( const sim_collision_t &p_collision )
+{
+  score += p_collision.points;
+  if ( p_collision.destroyed )
+  {
+    drop_powerup( p_collision.brick );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * resolve_collisions - resolves every collision recorded since the last time
+ *                      we were called, in the order they happened in.
+ */
+
+void GameSim::resolve_collisions( void )
+{
+  while( resolved_count < collision_count )
+  {
+    resolve_collision( collisions[resolved_count++] );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * accessors - the outside world needs to see our state, to draw it.
+ */
+
+blit::Size GameSim::get_bounds( void )
+{
+  return bounds;
+}
+Level *GameSim::get_level( void )
+{
+  return &level;
+}
+uint8_t GameSim::get_lives( void )
+{
+  return lives;
+}
+uint16_t GameSim::get_score( void )
+{
+  return score;
+}
+sim_num_t GameSim::get_bat_position( void )
+{
+  return bat_position;
+}
+uint16_t GameSim::get_bat_height( void )
+{
+  return bat_height;
+}
+bat_type_t GameSim::get_bat_type( void )
+{
+  return bat_type;
+}
+ball_pool_t &GameSim::get_balls( void )
+{
+  return balls;
+}
+powerup_pool_t &GameSim::get_powerups( void )
+{
+  return powerups;
+}
+BallSwarm &GameSim::get_swarm( void )
+{
+  return swarm;
+}
+bool GameSim::get_mega_multiball( void )
+{
+  return mega_multiball;
+}
+uint8_t GameSim::get_substeps( void )
+{
+  return substeps;
+}
+
+
+/*
+ * get_event_count / get_event - expose the events generated in the last tick.
+ */
+
+uint8_t GameSim::get_event_count( void )
+{
+  return event_count;
+}
+const sim_event_t *GameSim::get_event( uint8_t p_index )
+{
+  /* Sanity check the index. */
+  if ( p_index >= event_count )
+  {
+    return nullptr;
+  }
+
+  return &events[p_index];
+}
+
+
+/*
+ * get_collision_count / get_collision - expose the collisions recorded since
+ *                                       they were last cleared.
+ */
+
+uint16_t GameSim::get_collision_count( void )
+{
+  return collision_count;
+}
+const sim_collision_t *GameSim::get_collision( uint16_t p_index )
+{
+  /* Sanity check the index. */
+  if ( p_index >= collision_count )
+  {
+    return nullptr;
+  }
+
+  return &collisions[p_index];
+}
+
+
+/*
+ * clear_collisions - forgets every collision recorded so far; they've all
+ *                    been scored by the end of an update, so this is only
+ *                    about the outside world having seen them.
+ */
+
+void GameSim::clear_collisions( void )
+{
+  collision_count = 0;
+  resolved_count = 0;
+
+  /* All done. */
+  return;
+}
+
+/* End of GameSim.cpp */
@@ -0,0 +1,223 @@
+/*
+ * GameSim.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The GameSim is the headless core of the game; it knows about balls, bats,
+ * bricks and powerups, but nothing about screens, buttons or speakers. Input
+ * goes in, events come out, and the GameState deals with the rest.
+ */
+
+#ifndef   _GAMESIM_HPP_
+#define   _GAMESIM_HPP_
+
+#include "Ball.hpp"
+#include "BallSwarm.hpp"
+#include "Level.hpp"
+#include "Pool.hpp"
+#include "PowerUp.hpp"
+
+
+typedef enum
+{
+  BAT_NORMAL,
+  BAT_NARROW,
+  BAT_WIDE,
+  BAT_STICKY,
+  BAT_MAX
+} bat_type_t;
+
+/* Bricks are laid out on a fixed grid, below the score line. */
+#define BRICK_WIDTH         32
+#define BRICK_HEIGHT        16
+#define BRICK_TOP           10
+
+/* The simulation ticks every 10ms, whatever the frame rate; the physics in */
+/* each tick can be split into a few substeps, for more resolution.         */
+#define SIM_TICK_MS         10
+#define SIM_MAX_SUBSTEPS    4
+
+/* A ball can touch at most two bricks with its leading edge, at a contact. */
+#define SIM_MAX_CONTACT     2
+
+typedef struct
+{
+  sim_num_t           fraction;
+  bool                horizontal;
+  uint8_t             brick_count;
+  blit::Point         bricks[SIM_MAX_CONTACT];
+} sim_contact_t;
+
+/* Balls and powerups live in fixed pools, so a game never touches the heap; */
+/* the PicoSystem is short of memory, so it gets rather smaller ones. These  */
+/* are only how much room there is; the limits in play are below.            */
+#ifdef    PICO_BUILD
+#define SIM_MAX_BALLS       32
+#define SIM_MAX_POWERUPS    16
+#else
+#define SIM_MAX_BALLS       64
+#define SIM_MAX_POWERUPS    32
+#endif /* PICO_BUILD */
+
+typedef Pool<Ball, SIM_MAX_BALLS>       ball_pool_t;
+typedef Pool<PowerUp, SIM_MAX_POWERUPS> powerup_pool_t;
+
+/* How much a game can have going on at once is part of the rules of the */
+/* target it's played for, not of whatever it happens to be running on;   */
+/* otherwise a desktop replay of a PicoSystem game would play differently. */
+typedef struct
+{
+  uint16_t            balls;
+  uint16_t            powerups;
+  uint16_t            swarm;
+  uint16_t            swarm_batch;
+} sim_limits_t;
+
+/* Input is boiled down to a couple of bytes per tick; the buttons that are */
+/* held, the ones that were just pressed, and a quantised joystick.         */
+#define SIM_INPUT_LEFT      0x01
+#define SIM_INPUT_RIGHT     0x02
+#define SIM_INPUT_LAUNCH    0x04
+
+typedef struct
+{
+  uint8_t             buttons;
+  int8_t              joystick;
+} sim_input_t;
+
+/* Events are everything that happened in a tick that the outside world */
+/* might want to react to - noises, buzzes and messages, mostly.        */
+#define SIM_MAX_EVENTS      64
+
+typedef enum
+{
+  SIM_EVENT_POWERUP_DROPPED,
+  SIM_EVENT_POWERUP_FALLING,
+  SIM_EVENT_POWERUP_COLLECTED,
+  SIM_EVENT_BALL_LOST,
+  SIM_EVENT_LEVEL_COMPLETE
+} sim_event_type_t;
+
+typedef struct
+{
+  sim_event_type_t    type;
+  uint16_t            value;
+} sim_event_t;
+
+
+/* Collisions are kept apart from the other events, as there can be a lot */
+/* of them; they're settled (scored, and maybe drop a powerup) at the end  */
+/* of each step, but are kept until the outside world clears them, so that */
+/* it can react to a whole frame's worth of them at once.                  */
+#ifdef    PICO_BUILD
+#define SIM_MAX_COLLISIONS  64
+#else
+#define SIM_MAX_COLLISIONS  256
+#endif /* PICO_BUILD */
+
+/* Balls in a collision are identified by their slot in the ball pool, or */
+/* by their index in the swarm with this bit set.                         */
+#define SIM_BALL_SWARM      0x8000
+
+typedef enum
+{
+  SIM_COLLISION_BOUNDS,
+  SIM_COLLISION_BRICK,
+  SIM_COLLISION_BAT
+} sim_collision_type_t;
+
+typedef struct
+{
+  sim_collision_type_t type;
+  blit::Point         position;
+  blit::Point         brick;
+  uint16_t            ball;
+  uint8_t             points;
+  bool                destroyed;
+} sim_collision_t;
+
+
+class GameSim
+{
+private:
+  blit::Size                  bounds;
+  target_type_t               target;
+  const sim_limits_t         *limits;
+  Level                       level;
+  LevelSource                *level_source;
+  uint8_t                     lives;
+  uint16_t                    score;
+  uint32_t                    rng_state;
+  sim_num_t                   bat_position;
+  sim_num_t                   last_bat_position;
+  sim_num_t                   bat_speed;
+  uint16_t                    bat_height;
+  bat_type_t                  bat_type;
+  ball_pool_t                 balls;
+  powerup_pool_t              powerups;
+  BallSwarm                   swarm;
+  bool                        mega_multiball;
+  uint8_t                     substeps;
+  sim_event_t                 events[SIM_MAX_EVENTS];
+  uint8_t                     event_count;
+  sim_collision_t             collisions[SIM_MAX_COLLISIONS];
+  uint16_t                    collision_count;
+  uint16_t                    resolved_count;
+  const uint8_t               bat_width[BAT_MAX] = { 24, 16, 32, 24 };
+
+  void                        add_event( sim_event_type_t, uint16_t = 0 );
+  void                        add_collision( sim_collision_type_t, sim_vec_t, uint16_t,
+                                             uint8_t = 0, const blit::Point * = nullptr );
+  void                        resolve_collision( const sim_collision_t & );
+  void                        resolve_collisions( void );
+  void                        move_bat( sim_num_t );
+  void                        spawn_ball( bool );
+  void                        apply_powerup( powerup_type_t );
+  void                        hit_bricks( const sim_contact_t &, sim_vec_t, uint16_t );
+  void                        drop_powerup( blit::Point );
+  void                        update_swarm( void );
+  void                        step( bool );
+  sim_num_t                   step_speed( sim_num_t );
+  bool                        find_bricks( int16_t, int16_t, int16_t, int16_t, sim_contact_t * );
+  bool                        sweep_bricks( sim_vec_t, sim_vec_t, sim_num_t, sim_contact_t * );
+
+public:
+                              GameSim( blit::Size, target_type_t );
+  void                        reset( uint32_t );
+  void                        load_level( uint16_t );
+  void                        set_level_source( LevelSource * );
+  void                        update( const sim_input_t & );
+  void                        add_balls( uint8_t );
+  void                        add_swarm( uint16_t );
+  void                        set_mega_multiball( bool );
+  bool                        get_mega_multiball( void );
+  void                        set_substeps( uint8_t );
+  uint8_t                     get_substeps( void );
+  uint32_t                    random( void );
+  uint32_t                    get_hash( void );
+  blit::Rect                  brick_to_screen( uint8_t, uint8_t );
+  blit::Point                 screen_to_brick( blit::Point );
+  blit::Rect                  bat_bounds( void );
+  blit::Rect                  bat_render_bounds( sim_num_t );
+  blit::Size                  get_bounds( void );
+  Level                      *get_level( void );
+  uint8_t                     get_lives( void );
+  uint16_t                    get_score( void );
+  sim_num_t                   get_bat_position( void );
+  uint16_t                    get_bat_height( void );
+  bat_type_t                  get_bat_type( void );
+  ball_pool_t                &get_balls( void );
+  powerup_pool_t             &get_powerups( void );
+  BallSwarm                  &get_swarm( void );
+  uint8_t                     get_event_count( void );
+  const sim_event_t          *get_event( uint8_t );
+  uint16_t                    get_collision_count( void );
+  const sim_collision_t      *get_collision( uint16_t );
+  void                        clear_collisions( void );
+};
+
+#endif /* _GAMESIM_HPP_ */
+
+/* End of GameSim.hpp */
@@ -11,19 +11,17 @@
 
 /* System headers. */
 
-#include <iterator>
-
+#include <new>
+#include <string.h>
 
 /* Local headers. */
 
 #include "32blit.hpp"
 #include "32blox.hpp"
-#include "assets_images.hpp"
 
 #include "GameState.hpp"
+#include "GameSim.hpp"
 #include "HighScore.hpp"
-#include "Level.hpp"
-#include "PowerUp.hpp"
 
 
 /* Functions. */
@@ -34,9 +32,22 @@
 
 GameState::GameState( void )
 {
-  /* The bat height will always be the same, but is bound by the screen size */
-  /* so can't quite be hard coded.                                           */
-  bat_height = blit::screen.bounds.h - 10;
+  /* The simulation does all the real work; it plays on the whole screen. */
+  sim = new GameSim( blit::screen.bounds, assets.get_platform() );
+  if ( TARGET_PICOSYSTEM == assets.get_platform() )
+  {
+    sim->set_substeps( GAMESTATE_PICO_SUBSTEPS );
+  }
+  else
+  {
+    sim->set_substeps( GAMESTATE_SUBSTEPS );
+  }
+
+  /* Every game gets recorded, so that it can be replayed later. */
+  recorder = new Recorder();
+
+  /* And any level pack is only opened while a game is being played. */
+  level_pack = new LevelPack();
 
   /* The font pen will be simpler. */
   font_pen = blit::Pen( 255, 255, 0 );
@@ -49,6 +60,17 @@ GameState::GameState( void )
   /* Prepare the tween for splashing messages. */
   splash_tween.init( blit::tween_linear, 255.0f, 0.0f, 1750, 1 );
 
+  /* The spritesheet and background layer only exist while we're active. */
+  spritesheet = nullptr;
+  background_data = nullptr;
+  background = nullptr;
+  background_valid = false;
+  drawn_score = 0;
+  drawn_lives = 0;
+  dirty.set_bounds( blit::screen.bounds );
+  sprites.set_bounds( blit::screen.bounds );
+  last_sprites.set_bounds( blit::screen.bounds );
+
   /* All done. */
   return;
 }
@@ -62,8 +84,22 @@ GameState::GameState( void )
 
 void GameState::init( GameStateInterface *p_previous )
 {
-  /* Select the game spritesheet into the screen. */
-  blit::screen.sprites = assets.spritesheet_game;
+  /* Fetch the game spritesheet. */
+  spritesheet = assets.acquire( ASSET_GAME_SPRITES );
+
+  /* Set up a background layer the same shape as the screen; if there's not */
+  /* the memory for one, we'll just have to draw everything, every frame.   */
+  background_data = new( std::nothrow ) uint8_t[
+    blit::screen.bounds.w * blit::screen.bounds.h * blit::screen.pixel_stride
+  ];
+  if ( background_data != nullptr )
+  {
+    background = new blit::Surface( background_data, blit::screen.format, blit::screen.bounds );
+  }
+
+  /* Whatever was on the screen before, we need to draw over all of it. */
+  invalidate();
+  last_sprites.clear();
 
   /* Fetch the current top score. */
   const hiscore_t *l_top_entry = high_score->get_entry( 0 );
@@ -76,16 +112,49 @@ void GameState::init( GameStateInterface *p_previous )
     hiscore = l_top_entry->score;
   }
 
-  /* Load the first level. */
-  load_level( 1 );
+  /* If there's a level pack that suits us, play that instead of the */
+  /* built-in levels; it's looked for every game, so it can be swapped. */
+  if ( level_pack->open( GAME_DATAFILE_LEVELS, assets.get_platform() ) )
+  {
+    sim->set_level_source( level_pack );
+  }
+  else
+  {
+    sim->set_level_source( nullptr );
+  }
+
+  /* Mega multiball is chosen from the menu, and holds for the whole game. */
+  sim->set_mega_multiball( output.mega_multiball_enabled() );
+
+  /* Start a fresh game in the simulation, from the first level. */
+  uint32_t l_seed = blit::random();
+  sim->reset( l_seed );
+  splash_level();
+
+  /* The clock starts with the first update. */
+  clock_started = false;
+  last_time = 0;
+  accumulator = 0;
+  pending_launch = false;
+
+  /* And record it, where we can; the PicoSystem has nowhere to save it. */
+  if ( TARGET_PICOSYSTEM != assets.get_platform() )
+  {
+    replay_header_t l_header;
+    l_header.version = REPLAY_VERSION;
+    l_header.target = assets.get_platform();
+    l_header.flags = REPLAY_BUILD_FLAGS | ( sim->get_mega_multiball() ? REPLAY_FLAG_MEGA : 0 ) |
+                     ( level_pack->is_open() ? REPLAY_FLAG_PACK : 0 );
+    l_header.substeps = sim->get_substeps();
+    l_header.width = sim->get_bounds().w;
+    l_header.height = sim->get_bounds().h;
+    l_header.seed = l_seed;
+    recorder->start( &l_header );
+  }
 
   /* Set the tweens running. */
   font_tween.start();
 
-  /* Reset the lives count and score. */
-  lives = 3;
-  score = 0;
-
   /* All done. */
   return;
 }
@@ -103,173 +172,157 @@ void GameState::fini( GameStateInterface *p_next )
   font_tween.stop();
   splash_tween.stop();
 
-  /* All done. */
-  return;
-}
+  /* And finish off the recording, and the level pack. */
+  recorder->stop();
+  sim->set_level_source( nullptr );
+  level_pack->close();
 
-/*
- * move_bat - updates the bat position, taking into account the bat size and
- *            the edges of the screen.
- * float - the movement amount wanted; this may get clipped if the edge is hit
- */
-void GameState::move_bat( float p_movement )
-{
-  /* First up, let's apply the full movement. */
-  float l_last_pos = bat_position;
-  bat_position += p_movement;
-
-  /* And then clamp it, left and right, honouring any level margins. */
-  if ( bat_position < ( ( bat_width[bat_type] / 2 ) + level->get_margin() ) )
-  {
-    bat_position = ( bat_width[bat_type] / 2 ) + level->get_margin();
-  }
-  if ( bat_position > blit::screen.bounds.w - ( bat_width[bat_type] / 2 ) - level->get_margin() )
-  {
-    bat_position = blit::screen.bounds.w - ( bat_width[bat_type] / 2 ) - level->get_margin();
-  }
+  /* Let go of the background layer, so other states can have the memory. */
+  delete background;
+  delete[] background_data;
+  background = nullptr;
+  background_data = nullptr;
 
-  /* Now, ask our balls to respond to the current bat. */
-  for ( auto l_ball : balls )
-  {
-    /* Then we can just ask the ball to move itself, if it wants to. */
-    l_ball->move_bat( bat_bounds(), bat_position - l_last_pos, bat_type == BAT_STICKY );
-  }
+  /* And the spritesheet, which the next state may not want. */
+  assets.release( ASSET_GAME_SPRITES );
 
-  /* All done! */
+  /* All done. */
   return;
 }
 
 
 /*
- * brick_to_screen - returns a Rect of the position of the designated brick,
- *                   to make rendering and collision detection nice and consistent.
- * uint8_t * 2 - the row and column in the brick being queried.
+ * splash_level - lets the user know what level they're on.
  */
 
-blit::Rect GameState::brick_to_screen( uint8_t p_row, uint8_t p_column )
+void GameState::splash_level( void )
 {
-  return blit::Rect( ( p_column * 32 ) + level->get_margin(), p_row * 16 + 10, 32, 16 );
-}
-
-
-/*
- * screen_to_brick - returns the x/y co-ordinates of the brick at the given
- *                   screen location.
- * blit::Point - the screen location being queried.
- */
-
-blit::Point GameState::screen_to_brick( blit::Point p_location )
-{
-  /* Clamp the location to the screen, in case a bounding box has slipped */
-  /* off somewhere, which can get ... messy.                              */
-  blit::Point l_location = blit::screen.clip.clamp( p_location );
-
-  return blit::Point( ( l_location.x - level->get_margin() ) / 32, ( l_location.y - 10 ) / 16 );
-}
-
-
-/*
- * bat_bounds - returns a Rect defining the countaining bounds of the current
- *              bat. This take into account the bat type, so dynimcally changes
- *              if, for example, a powerup changes the bat.
- */
+  snprintf( splash_message, 30, "%s\n%02d", assets.get_text( STR_LEVEL ), sim->get_level()->get_level() );
+  splash_tween.start();
 
-blit::Rect GameState::bat_bounds( void )
-{
-  return blit::Rect( 
-                     bat_position - ( bat_width[bat_type] / 2 ),
-                     bat_height,
-                     bat_width[bat_type],
-                     8
-                   );
+  /* All done. */
+  return;
 }
 
 
 /*
- * spawn_ball - creates a new ball; on the bat - either at the start of the 
- *              level, or after a ball is lost - when the flag is set, or at
- *              the location of another ball in 'mid flight', when false.
+ * handle_event - responds to something that happened in the simulation, with
+ *                suitable noises, buzzes and messages.
+ *
+ * sim_event_t * - the event to respond to
  */
 
-void GameState::spawn_ball( bool pBat )
+void GameState::handle_event( const sim_event_t *p_event )
 {
-  Ball *l_ball;
-  blit::Point l_ballpos;
-
-  /* Work out the right place for the ball to be. */
-  if ( pBat )
+  switch( p_event->type )
   {
-    /* The ball starts in the middle of the bat. */
-    l_ballpos = blit::Point( bat_position, bat_height - 3 );
+    case SIM_EVENT_POWERUP_FALLING: /* Update the falling noise effect. */
+      output.play_effect_falling( p_event->value );
+      break;
 
-    /* But then we offset it a little one side or the other... */
-    switch( blit::random() % 4 )
-    {
-      case 0:
-        l_ballpos.x -= 4;
+    case SIM_EVENT_POWERUP_COLLECTED:
+      /* Splash a message for it. */
+      switch( p_event->value )
+      {
+      case POWERUP_SPEED:
+        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_SPEED ) );
         break;
-      case 1:
-        l_ballpos.x -= 2;
+      case POWERUP_SLOW:
+        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_SLOW ) );
         break;
-      case 2:
-        l_ballpos.x += 2;
+      case POWERUP_STICKY:
+        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_STICKY ) );
         break;
-      case 3:
-        l_ballpos.x += 4;
+      case POWERUP_GROW:
+        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_GROW ) );
         break;
-    }
+      case POWERUP_SHRINK:
+        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_SHRINK ) );
+        break;
+      case POWERUP_MULTI:
+        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_MULTI ) );
+        break;
+      case POWERUP_EXTRA:
+        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_EXTRA ) );
+        break;
+      }
+      splash_tween.start();
 
-    /* create a new ball. */
-    l_ball = new Ball( l_ballpos, level->get_ball_speed() );
+      /* Turn off the falling sound, and Ping! */
+      output.play_effect_falling( 0 );
+      output.play_effect_pickup();
+      break;
 
-    /* Stick it to the bat. */
-    l_ball->stuck = true;
-  }
-  else
-  {
-    /* Grab the location of the first ball in the queue. */
-    auto l_current_ball = balls.front();
-    l_ballpos = l_current_ball->get_bounds().center();
+    case SIM_EVENT_BALL_LOST:       /* Lost a ball; the value is lives left. */
+      if ( p_event->value == 0 )
+      {
+        snprintf( splash_message, 30, "%s", assets.get_text( STR_GAME_OVER ) );
+      }
+      else
+      {
+        snprintf( splash_message, 30, "%s", assets.get_text( STR_BALL_LOST ) );
+      }
+      splash_tween.start();
+      break;
 
-    /* create a new ball. */
-    l_ball = new Ball( l_ballpos, level->get_ball_speed() );
-    l_ball->randomise();
+    case SIM_EVENT_LEVEL_COMPLETE:  /* Cleared the level, onto the next! */
+      output.play_effect_level_complete();
+      splash_level();
+      break;
   }
 
-  /* And add it to the internal ball list. */
-  l_ball->move_bat( bat_bounds(), 0.0f, false );
-  balls.push_front( l_ball );
-
   /* All done. */
   return;
 }
 
 
 /*
- * load_level - loads the required level data, resets the balls, the bats and
- *              everything else for the start of a whole new level
+ * play_collisions - responds to everything the balls have run into since we
+ *                   last looked; rather than retriggering the bounce voice
+ *                   for every one of them, the hardest hit is the one that
+ *                   gets heard, and felt.
  */
 
-void GameState::load_level( uint8_t p_level )
+void GameState::play_collisions( void )
 {
-  /* Load up the level data. */
-  level = new Level( p_level, assets.get_platform() );
+  float    l_strength = 0.0f;
+  uint16_t l_frequency = 0;
+
+  for ( uint16_t l_index = 0; l_index < sim->get_collision_count(); l_index++ )
+  {
+    const sim_collision_t *l_collision = sim->get_collision( l_index );
+    float    l_hit_strength = HAPTIC_BOUNCE;
+    uint16_t l_hit_frequency = FREQ_BOUNDS;
 
-  /* Centre the bat, and set it to a default type. */
-  bat_position = blit::screen.bounds.w / 2;
-  bat_speed = 1.0f;
-  bat_type = BAT_NORMAL;
+    /* The edges and the bat sound the same; bricks are a little different, */
+    /* and breaking one gives a harder knock.                                */
+    if ( l_collision->type == SIM_COLLISION_BRICK )
+    {
+      l_hit_frequency = FREQ_BRICK;
+      if ( l_collision->destroyed )
+      {
+        l_hit_strength = HAPTIC_BREAK;
+      }
+    }
 
-  /* Clear out the list of balls, and spawn one on the bat. */
-  balls.clear();
-  spawn_ball( true );
+    /* Keep the hardest hit; between equals, a brick is more interesting. */
+    if ( l_hit_strength > l_strength ||
+         ( l_hit_strength == l_strength && l_hit_frequency > l_frequency ) )
+    {
+      l_strength = l_hit_strength;
+      l_frequency = l_hit_frequency;
+    }
+  }
 
-  /* Clear out the list of powerups, too. */
-  powerups.clear();
+  /* If anything was hit at all, that's one bounce and one buzz. */
+  if ( l_frequency > 0 )
+  {
+    output.trigger_haptic( l_strength, HAPTIC_MS );
+    output.play_effect_bounce( l_frequency );
+  }
 
-  /* Let the user know what level they're on. */
-  snprintf( splash_message, 30, "%s\n%02d", assets.get_text( STR_LEVEL ), level->get_level() );
-  splash_tween.start();
+  /* They've all been scored already, so we're done with them. */
+  sim->clear_collisions();
 
   /* All done. */
   return;
@@ -282,469 +335,309 @@ void GameState::load_level( uint8_t p_level )
 
 uint16_t GameState::get_score( void )
 {
-  return score;
+  return sim->get_score();
 }
 
 
 /*
- * update - called every tick (~10ms) to update the state of the game.
- * 
- * uint32_t - the elapsed time (in ms) since the game launched.
+ * tick - runs a single tick of the simulation, with the controls as they
+ *        are right now, and responds to whatever happened in it.
  */
 
-gamestate_t GameState::update( uint32_t p_time )
+void GameState::tick( void )
 {
-  /* Calculate any bat movement that's required. */
-  float l_movement = 0.0f;
+  sim_input_t l_input;
 
-  /* Handle the joystick, which is slightly more gradiated. */
-  if ( blit::joystick.x < -0.66f )
+  /* Boil the controls down into something the simulation understands. */
+  l_input.buttons = 0;
+  l_input.joystick = (int8_t)( blit::joystick.x * 127.0f );
+  if ( blit::buttons.state & blit::Button::DPAD_LEFT )
   {
-    l_movement = bat_speed * -1;
+    l_input.buttons |= SIM_INPUT_LEFT;
   }
-  else if ( blit::joystick.x > 0.66f )
+  if ( blit::buttons.state & blit::Button::DPAD_RIGHT )
   {
-    l_movement = bat_speed;
+    l_input.buttons |= SIM_INPUT_RIGHT;
   }
-  else
+  if ( pending_launch )
   {
-    l_movement = bat_speed * 1.5f * blit::joystick.x;
+    l_input.buttons |= SIM_INPUT_LAUNCH;
+    pending_launch = false;
   }
 
-  /* But if the player has moved the dpad, then use that instead. */
-  if ( blit::buttons.state & blit::Button::DPAD_LEFT )
+  /* Let the simulation do it's thing. */
+  sim->update( l_input );
+
+  /* Record what we did, and where it left us. */
+  if ( recorder->is_active() )
   {
-    l_movement = bat_speed * -1;
+    recorder->record( &l_input, sim->get_hash() );
   }
-  if ( blit::buttons.state & blit::Button::DPAD_RIGHT )
+
+  /* And then respond to whatever happened. */
+  for ( uint8_t l_index = 0; l_index < sim->get_event_count(); l_index++ )
   {
-    l_movement = bat_speed;
+    handle_event( sim->get_event( l_index ) );
   }
 
-  /* And lastly, apply that movement. */
-  if ( l_movement != 0.0f )
+  /* All done. */
+  return;
+}
+
+
+/*
+ * update - called every tick (~10ms) to update the state of the game; that's
+ *          not guaranteed though, so we run the simulation for however much
+ *          time has actually passed.
+ * 
+ * uint32_t - the elapsed time (in ms) since the game launched.
+ */
+
+gamestate_t GameState::update( uint32_t p_time )
+{
+  /* The first update runs a tick straight away. */
+  if ( !clock_started )
   {
-    move_bat( l_movement );
+    last_time = p_time - SIM_TICK_MS;
+    clock_started = true;
   }
 
-  /* Next, if the user presses B and there's a ball on the bat, fire it. */
-  /* And yes, if we've collected multiple balls, we launch them all!     */
-  if ( blit::buttons.pressed & blit::Button::B && lives > 0 )
+  /* Add on however long it's been, up to the most we'll catch up on. */
+  accumulator += p_time - last_time;
+  last_time = p_time;
+  if ( accumulator > SIM_TICK_MS * GAMESTATE_MAX_CATCHUP )
   {
-    /* Work through all our balls then. */
-    for ( auto l_ball : balls )
-    {
-      /* Only interested in one that's stuck. */
-      if ( l_ball->stuck )
-      {
-        /* Balls know how to launch themselves, happily. */
-        l_ball->launch();
+    accumulator = SIM_TICK_MS * GAMESTATE_MAX_CATCHUP;
+  }
 
-        /* But only launch one... */
-        break;
-      }
-    }
+  /* Button presses are only seen by the update they happen in, so hang on */
+  /* to them until there's a tick to use them.                             */
+  if ( blit::buttons.pressed & blit::Button::B )
+  {
+    pending_launch = true;
   }
 
-  /* Next up, we work our way through all the balls we have, and update their */
-  /* positions. We'll deal with any collisions in a little while...           */
-  for ( auto l_ball : balls )
+  /* And then run as many ticks as that time covers. */
+  while( accumulator >= SIM_TICK_MS )
   {
-    bool l_bounce_vertical = false;
-    bool l_bounce_horizontal = false;
-    bool l_brick_destroyed = false;
-    blit::Point l_brick_location;
+    tick();
+    accumulator -= SIM_TICK_MS;
+  }
 
-    /* Fetch the bounds of the ball's current position. */
-    blit::Rect l_old_bounds = l_ball->get_bounds();
+  /* Everything that got hit in all those ticks makes just the one noise. */
+  play_collisions();
 
-    /* Update the balls position. */
-    l_ball->update();
+  /* If after all that we have no more lives, it's game over. */
+  if ( sim->get_lives() == 0 && splash_tween.is_finished() ) 
+  {
+    return STATE_DEATH;
+  }
 
-    /* And fetch the bounds of the ball in it's new location. */
-    blit::Rect l_new_bounds = l_ball->get_bounds();
+  /* The font pen we use will pulse more subtlely. */
+  font_pen.g = font_tween.value;
 
-    /* Collision detect on the top of the screen. */
-    if ( l_new_bounds.y <= 0 )
-    {
-      output.trigger_haptic( 0.25f, 50 );
-      output.play_effect_bounce( FREQ_BOUNDS );
-      l_ball->bounce( false );
-    }
+  /* All done, remain in our current state */
+  return STATE_GAME;
+}
 
-    /* And the edges of the screen, which gives some points too! */
-    if ( ( l_new_bounds.x <= level->get_margin() && l_ball->moving_left() )
-         || 
-         ( ( l_new_bounds.x + l_new_bounds.w ) >= ( blit::screen.bounds.w - level->get_margin() ) && !l_ball->moving_left() ) )
-    {
-      score++;
-      output.trigger_haptic( 0.25f, 50 );
-      output.play_effect_bounce( FREQ_BOUNDS );
-      l_ball->bounce( true );
-    }
 
-    /* Now, check to see if our bounds have crossed into a new brick area. */
-    if ( l_ball->moving_up() )
-    {
-      /* Check if the brick row has changed for the leading (top) edge. */
-      blit::Point l_old_tl = screen_to_brick( l_old_bounds.tl() );
-      blit::Point l_new_tl = screen_to_brick( l_new_bounds.tl() );
-      blit::Point l_new_tr = screen_to_brick( l_new_bounds.tr() );
-      if ( l_old_tl.y != l_new_tl.y )
-      {
-        /* We've crossed a line. See if it's occupied! */
-        if ( level->get_brick( l_new_tl ) > 0 )
-        {
-          /* Bounce and increment the score. */
-          score += level->hit_brick( l_new_tl );
-          l_bounce_vertical = true;
-
-          /* Check to see if the brick was destroyed. */
-          if ( level->get_brick( l_new_tl ) == 0 )
-          {
-            l_brick_destroyed = true;
-            l_brick_location = l_new_tl;
-          }
-        }
-
-        /* Also consider the top right corner, in case we bounced on a boundary. */
-        if ( ( l_new_tl.x != l_new_tr.x ) || ( l_new_tl.y != l_new_tr.y ) )
-        {
-          if ( level->get_brick( l_new_tr ) > 0 )
-          {
-            /* Bounce, and increment the score. */
-            score += level->hit_brick( l_new_tr );
-            l_bounce_vertical = true;
-
-            /* Check to see if the brick was destroyed. */
-            if ( level->get_brick( l_new_tr ) == 0 )
-            {
-              l_brick_destroyed = true;
-              l_brick_location = l_new_tr;
-            }
-          }
-        }
-      }
-    }
-    else
-    {
-      /* Moving down, check if the brick row has changed on the bottom edge. */
-      blit::Point l_old_bl = screen_to_brick( l_old_bounds.bl() );
-      blit::Point l_new_bl = screen_to_brick( l_new_bounds.bl() );
-      blit::Point l_new_br = screen_to_brick( l_new_bounds.br() );
-      if ( l_old_bl.y != l_new_bl.y )
-      {
-        /* We've crossed a line. See if it's occupied! */
-        if ( level->get_brick( l_new_bl ) > 0 )
-        {
-          /* Bounce, and increment the score. */
-          score += level->hit_brick( l_new_bl );
-          l_bounce_vertical = true;
-
-          /* Check to see if the brick was destroyed. */
-          if ( level->get_brick( l_new_bl ) == 0 )
-          {
-            l_brick_destroyed = true;
-            l_brick_location = l_new_bl;
-          }
-        }
-
-        /* Also consider the top right corner, in case we bounced on a boundary. */
-        if ( ( l_new_bl.x != l_new_br.x ) || ( l_new_bl.y != l_new_br.y ) )
-        {
-          if ( level->get_brick( l_new_br ) > 0 )
-          {
-            /* Bounce, and increment the score. */
-            score += level->hit_brick( l_new_br );
-            l_bounce_vertical = true;
-
-            /* Check to see if the brick was destroyed. */
-            if ( level->get_brick( l_new_br ) == 0 )
-            {
-              l_brick_destroyed = true;
-              l_brick_location = l_new_br;
-            }
-          }
-        }
-      }
-    }
-    if ( l_ball->moving_left() )
-    {
-      /* Check if the brick row has changed for the leading (left) edge. */
-      blit::Point l_old_tl = screen_to_brick( l_old_bounds.tl() );
-      blit::Point l_new_tl = screen_to_brick( l_new_bounds.tl() );
-      blit::Point l_new_bl = screen_to_brick( l_new_bounds.bl() );
-      if ( l_old_tl.x != l_new_tl.x )
-      {
-        /* We've crossed a line. See if it's occupied! */
-        if ( level->get_brick( l_new_tl ) > 0 )
-        {
-          /* Bounce, and increment the score. */
-          score += level->hit_brick( l_new_tl );
-          l_bounce_horizontal = true;
-
-          /* Check to see if the brick was destroyed. */
-          if ( level->get_brick( l_new_tl ) == 0 )
-          {
-            l_brick_destroyed = true;
-            l_brick_location = l_new_tl;
-          }
-        }
-
-        /* Also consider the top right corner, in case we bounced on a boundary. */
-        if ( ( l_new_tl.x != l_new_bl.x ) || ( l_new_tl.y != l_new_bl.y ) )
-        {
-          if ( level->get_brick( l_new_bl ) > 0 )
-          {
-            /* Bounce, and increment the score. */
-            score += level->hit_brick( l_new_bl );
-            l_bounce_horizontal = true;
-
-            /* Check to see if the brick was destroyed. */
-            if ( level->get_brick( l_new_bl ) == 0 )
-            {
-              l_brick_destroyed = true;
-              l_brick_location = l_new_bl;
-            }
-          }
-        }
-      }
-    }
-    else
-    {
-      /* Moving down, check if the brick row has changed on the bottom edge. */
-      blit::Point l_old_tr = screen_to_brick( l_old_bounds.tr() );
-      blit::Point l_new_tr = screen_to_brick( l_new_bounds.tr() );
-      blit::Point l_new_br = screen_to_brick( l_new_bounds.br() );
-      if ( l_old_tr.x != l_new_tr.x )
-      {
-        /* We've crossed a line. See if it's occupied! */
-        if ( level->get_brick( l_new_tr ) > 0 )
-        {
-          /* Bounce, and increment the score. */
-          score += level->hit_brick( l_new_tr );
-          l_bounce_horizontal = true;
-
-          /* Check to see if the brick was destroyed. */
-          if ( level->get_brick( l_new_tr ) == 0 )
-          {
-            l_brick_destroyed = true;
-            l_brick_location = l_new_tr;
-          }
-        }
-
-        /* Also consider the top right corner, in case we bounced on a boundary. */
-        if ( ( l_new_tr.x != l_new_br.x ) || ( l_new_tr.y != l_new_br.y ) )
-        {
-          if ( level->get_brick( l_new_br ) > 0 )
-          {
-            /* Bounce, and increment the score. */
-            score += level->hit_brick( l_new_br );
-            l_bounce_horizontal = true;
-
-            /* Check to see if the brick was destroyed. */
-            if ( level->get_brick( l_new_br ) == 0 )
-            {
-              l_brick_destroyed = true;
-              l_brick_location = l_new_br;
-            }
-          }
-        }
-      }
-    }
+/*
+ * invalidate - something else has drawn over the screen, so the next frame
+ *              has to be drawn from scratch.
+ */
 
-    /* Apply the required ball bounces. */
-    if ( l_bounce_vertical )
-    {
-      output.trigger_haptic( 0.25f, 50 );
-      output.play_effect_bounce( FREQ_BRICK );
-      l_ball->bounce( false );
-    }
-    if ( l_bounce_horizontal )
-    {
-      output.trigger_haptic( 0.25f, 50 );
-      output.play_effect_bounce( FREQ_BRICK );
-      l_ball->bounce( true );
-    }
+void GameState::invalidate( void )
+{
+  background_valid = false;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * draw_background - draws everything that doesn't move - the backdrop, the
+ *                   walls and the bricks - onto a surface; normally that's
+ *                   the background layer, but it can be the screen itself.
+ *
+ * blit::Surface * - the surface to draw onto
+ */
+
+void GameState::draw_background( blit::Surface *p_surface )
+{
+  Level *l_level = sim->get_level();
+
+  /* Draw a smooth gradient backdrop. */
+  backdrop.draw( BACKDROP_GAME, p_surface, blit::Rect( blit::Point( 0, 0 ), p_surface->bounds ) );
 
-    /* If a brick was fully destroyed, maybe spawn a powerup. */
-    if ( ( l_brick_destroyed )  && ( ( blit::random() % 10 ) <= ( level->get_level() / 3 ) ) )
+  /* If we have a margin, we need to draw some walls in. */
+  if ( l_level->get_margin() > 0 )
+  {
+    p_surface->pen = number_pen;
+    for ( int l_index = l_level->get_margin() - 1; l_index >= 0; l_index-- )
     {
-      /* Work out the screen location of the brick. */
-      blit::Rect l_brick = brick_to_screen( l_brick_location.y, l_brick_location.x );
-      powerups.push_front( new PowerUp( l_brick.center() ) );
+      p_surface->alpha = 255 - ( l_index * ( 200 / l_level->get_margin() ) );
+      p_surface->v_span(
+        blit::Point( l_index, 10 ), p_surface->bounds.h - 10
+      );
+      p_surface->v_span(
+        blit::Point( p_surface->bounds.w - l_index, 10 ), p_surface->bounds.h - 10
+      );
     }
 
-    /* And lastly, the bat itself. */
-    if ( ( l_new_bounds.x < ( bat_position + bat_width[bat_type] / 2 ) ) &&
-         ( ( l_new_bounds.x + l_new_bounds.w ) > ( bat_position - bat_width[bat_type] / 2 ) ) &&
-         ( ( l_new_bounds.y + l_new_bounds.h ) >= bat_height ) )
+    /* Reset the alpha. */
+    p_surface->alpha = 255;
+  }
+
+  /* Now we work through the level one brick at a time, skipping straight */
+  /* past the empty rows and cells using the occupancy masks.             */
+  for ( uint8_t l_row = 0; l_row < l_level->get_height(); l_row++ )
+  {
+    uint16_t l_mask = l_level->get_row_mask( l_row );
+    while ( l_mask != 0 )
     {
-      if ( l_ball->bat_bounce( bat_height, bat_type == BAT_STICKY ) )
-      {
-        output.trigger_haptic( 0.25f, 50 );
-        output.play_effect_bounce( FREQ_BOUNDS );
-      }
+      /* Fetch the brick for the next occupied location. */
+      uint8_t l_column = count_trailing_zeros( l_mask );
+      l_mask &= l_mask - 1;
+      uint8_t l_brick = l_level->get_brick( l_row, l_column );
+
+      /* Then draw the appropriate brick from the spritesheet. */
+      spritesheet->sprite(
+        p_surface,
+        blit::Rect( ( l_brick - 1 ) * 4, SPRITE_ROW_BRICK, 4, 2 ),
+        sim->brick_to_screen( l_row, l_column ).tl()
+      );
     }
   }
 
-  /* Clean up any balls that drop off the bottom of the screen. */
-  balls.remove_if( [](auto l_ball) { return l_ball->get_bounds().y > blit::screen.bounds.h; } );
+  /* That's everything the level had to tell us about. */
+  l_level->clear_changes();
 
-  /* Work through all the powerups. */
-  for ( auto l_powerup : powerups )
-  {
-    /* Update the powerup position. */
-    l_powerup->update();
-    blit::Rect l_powerup_bounds = l_powerup->get_bounds();
+  /* All done. */
+  return;
+}
 
-    /* Update the falling noise effect. */
-    output.play_effect_falling( l_powerup_bounds.center().y );
 
-    /* And then check to see if there's a collision with the bat. */
-    if ( l_powerup_bounds.intersects( bat_bounds() ) )
-    {
-      /* Apply the amazing power up. */
-      switch( l_powerup->get_type() )
-      {
-      case POWERUP_SPEED:
-        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_SPEED ) );
-        bat_speed += 0.8f;
-        break;
-      case POWERUP_SLOW:
-        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_SLOW ) );
-        bat_speed -= 0.6f;
-        if ( bat_speed < 0.5f )
-        {
-          bat_speed = 0.5f;
-        }
-        break;
-      case POWERUP_STICKY:
-        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_STICKY ) );
-        bat_type = BAT_STICKY;
-        break;
-      case POWERUP_GROW:
-        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_GROW ) );
-        if ( bat_type == BAT_NARROW )
-        {
-          bat_type = BAT_NORMAL;
-        }
-        else
-        {
-          bat_type = BAT_WIDE;
-        }
-        break;
-      case POWERUP_SHRINK:
-        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_SHRINK ) );
-        if ( bat_type == BAT_WIDE )
-        {
-          bat_type = BAT_NORMAL;
-        }
-        else
-        {
-          bat_type = BAT_NARROW;
-        }
-        break;
-      case POWERUP_MULTI:
-        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_MULTI ) );
-        spawn_ball( false );
-        spawn_ball( false );
-        break;
-      case POWERUP_EXTRA:
-        snprintf( splash_message, 30, "%s", assets.get_text( STR_POWERUP_EXTRA ) );
-        lives++;
-        break;
-      }
-
-      /* Splash a message for it. */
-      splash_tween.start();
+/*
+ * draw_brick - redraws a single brick in the background layer, once it's
+ *              been hit, and marks it as needing to be copied to the screen.
+ *
+ * uint8_t * 2 - the row and column of the brick
+ */
 
-      /* Grant some points for it! */
-      score += 15;
+void GameState::draw_brick( uint8_t p_row, uint8_t p_column )
+{
+  blit::Rect l_cell = sim->brick_to_screen( p_row, p_column );
+  uint8_t    l_brick = sim->get_level()->get_brick( p_row, p_column );
 
-      /* Turn off the falling sound, and Ping! */
-      output.play_effect_falling( 0 );
-      output.play_effect_pickup();
+  /* Put the backdrop back where the brick was... */
+  backdrop.draw( BACKDROP_GAME, background, l_cell );
 
-      /* And just drop the thing off the bottom of the screen; it'll get */
-      /* then get cleared up in a little while.                          */
-      l_powerup->remove();
-    }
+  /* ...and then whatever's left of the brick on top of it. */
+  if ( l_brick > 0 )
+  {
+    spritesheet->sprite(
+      background,
+      blit::Rect( ( l_brick - 1 ) * 4, SPRITE_ROW_BRICK, 4, 2 ),
+      l_cell.tl()
+    );
   }
+  dirty.add( l_cell );
 
-  /* And clean up any powerups that are off the screen too. */
-  powerups.remove_if( [](auto l_powerup) { return l_powerup->get_bounds().y > blit::screen.bounds.h; } );
+  /* All done. */
+  return;
+}
 
-  /* If there are no more balls in play, then we lose a life. */
-  if ( std::distance( balls.begin(), balls.end() ) == 0 )
-  {
-    /* Switch the bat back to standard type and speed, too. */
-    bat_speed = 1.0f;
-    bat_type = BAT_NORMAL;
 
-    /* Reduce our lives, spawn a fresh ball if we can. */
-    lives--;
-    spawn_ball( true );
-    if ( lives == 0 )
-    {
-      snprintf( splash_message, 30, "%s", assets.get_text( STR_GAME_OVER ) );
-    }
-    else
-    {
-      snprintf( splash_message, 30, "%s", assets.get_text( STR_BALL_LOST ) );
-    }
-    splash_tween.start();
-  }
+/*
+ * update_background - brings the background layer up to date with the level;
+ *                     normally that's just patching the odd brick that's been
+ *                     hit, but a new level means starting again. The level
+ *                     keeps track of what's changed since we last looked, so
+ *                     there's nothing to do at all on most frames.
+ */
 
-  /* If after all that we have no more lives, it's game over. */
-  if ( lives == 0 && splash_tween.is_finished() ) 
+void GameState::update_background( void )
+{
+  Level *l_level = sim->get_level();
+
+  /* If there's no background layer, we draw it all straight to the screen. */
+  if ( background == nullptr )
   {
-    return STATE_DEATH;
+    draw_background( &blit::screen );
+    dirty.add_all();
+    return;
   }
 
-  /* Lastly, check the level - if we've cleared all the clearable bricks, */
-  /* then it's time to move onto the next one!                            */
-  if ( level->get_brick_count() == 0 )
+  /* A whole new level (or a whole new screen) needs a whole new background. */
+  if ( !background_valid || l_level->is_reloaded() )
   {
-    output.play_effect_level_complete();
-    load_level( level->get_level() + 1 );
+    draw_background( background );
+    background_valid = true;
+    dirty.add_all();
+    return;
   }
 
-  /* The font pen we use will pulse more subtlely. */
-  font_pen.g = font_tween.value;
+  /* Otherwise, just patch up any bricks that have been hit. */
+  for ( uint8_t l_row = 0; l_row < l_level->get_height(); l_row++ )
+  {
+    uint16_t l_mask = l_level->get_changed_mask( l_row );
+    while ( l_mask != 0 )
+    {
+      draw_brick( l_row, count_trailing_zeros( l_mask ) );
+      l_mask &= l_mask - 1;
+    }
+  }
+  l_level->clear_changes();
 
-  /* All done, remain in our current state */
-  return STATE_GAME;
+  /* All done. */
+  return;
 }
 
 
 /*
- * render - called every frame (~20ms) to render the screen.
- * 
- * uint32_t - the elapsed time (in ms) since the game launched.
+ * restore - copies a part of the background layer back onto the screen; the
+ *           two are the same shape, so it's just a row of bytes at a time.
+ *
+ * blit::Rect - the area to restore
  */
 
-void GameState::render( uint32_t p_time )
+void GameState::restore( blit::Rect p_rect )
 {
-  uint8_t l_brick;
-  uint8_t l_lives_offset = 0;
-  bool    l_stuck_ball = false;
-  char    l_buffer[32];
+  /* If it was drawn straight to the screen, there's nothing to restore. */
+  if ( background == nullptr )
+  {
+    return;
+  }
 
-  /* Clear the screen down. */
-  blit::screen.clear();
+  uint32_t l_stride = blit::screen.bounds.w * blit::screen.pixel_stride;
+  uint32_t l_offset = p_rect.y * l_stride + p_rect.x * blit::screen.pixel_stride;
+  uint32_t l_length = p_rect.w * blit::screen.pixel_stride;
 
-  /* Draw a smooth gradient backdrop. */
-  for ( uint16_t i = 0; i < blit::screen.bounds.h; i++ )
+  for ( int32_t l_row = 0; l_row < p_rect.h; l_row++ )
   {
-    blit::screen.pen = blit::Pen( 10, 10, ( ( blit::screen.bounds.h - i ) / 2 ) );
-    blit::screen.h_span( blit::Point( 0, i ), blit::screen.bounds.w );
+    memcpy( blit::screen.data + l_offset, background->data + l_offset, l_length );
+    l_offset += l_stride;
   }
 
+  /* All done. */
+  return;
+}
+
+
+/*
+ * render_hud - draws the score line across the top of the screen.
+ */
+
+void GameState::render_hud( void )
+{
+  uint8_t     l_lives_offset = 0;
+  char        l_buffer[32];
+
   /* Draw in the score line. */
-  snprintf( l_buffer, 30, "%s: %05d", assets.get_text( STR_SCORE ), score );
+  snprintf( l_buffer, 30, "%s: %05d", assets.get_text( STR_SCORE ), sim->get_score() );
   blit::screen.pen = number_pen;
-  blit::screen.text(
+  text_cache.text(
     l_buffer,
     assets.number_font,
     blit::Point( 1, 1 ),
@@ -752,7 +645,7 @@ void GameState::render( uint32_t p_time )
     blit::TextAlign::top_left
   );
   snprintf( l_buffer, 30, "%s: %05d", assets.get_text( STR_HISCORE ), hiscore );
-  blit::screen.text(
+  text_cache.text(
     l_buffer,
     assets.number_font,
     blit::Point( blit::screen.bounds.w - 1, 1 ),
@@ -766,126 +659,220 @@ void GameState::render( uint32_t p_time )
     l_lives_offset = 10;
   }
 
-  blit::screen.sprite(
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 0, SPRITE_ROW_BAT, 1, 1 ),
     blit::Point( blit::screen.bounds.w / 2 - 24 + l_lives_offset, 1 )
   );
-  blit::screen.sprite(
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 2, SPRITE_ROW_BAT, 1, 1 ),
     blit::Point( blit::screen.bounds.w / 2 - 16 + l_lives_offset, 1 )
   );
-  snprintf( l_buffer, 30, "x%d", lives );
-  blit::screen.text( 
+  snprintf( l_buffer, 30, "x%d", sim->get_lives() );
+  text_cache.text( 
     l_buffer, 
     assets.number_font, 
     blit::Point( blit::screen.bounds.w / 2 - 4 + l_lives_offset, 1 ),
     true, blit::TextAlign::top_left
   );
 
-  /* If we have a margin, we need to draw some walls in. */
-  if ( level->get_margin() > 0 )
+  /* Remember what we drew, so we know when it needs drawing again. */
+  drawn_score = sim->get_score();
+  drawn_lives = sim->get_lives();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * text_bounds - works out the area covered by some centred text, with a
+ *               little to spare.
+ *
+ * const char *       - the text
+ * const blit::Font & - the font it's drawn in
+ * blit::Point        - the centre of the text
+ * bool               - true if the font is variable width
+ */
+
+blit::Rect GameState::text_bounds( const char *p_text, const blit::Font &p_font,
+                                   blit::Point p_centre, bool p_variable )
+{
+  blit::Size l_size = blit::screen.measure_text( p_text, p_font, p_variable );
+
+  return blit::Rect(
+    p_centre.x - l_size.w / 2 - 2, p_centre.y - l_size.h / 2 - 2,
+    l_size.w + 4, l_size.h + 4
+  );
+}
+
+
+/*
+ * render - called every frame (~20ms) to render the screen. Rather than draw
+ *          it all every time, we only redraw the parts that have changed; the
+ *          things that don't move are kept in a background layer, and copied
+ *          back over wherever something has moved.
+ * 
+ * uint32_t - the elapsed time (in ms) since the game launched.
+ */
+
+void GameState::render( uint32_t p_time )
+{
+  bool        l_stuck_ball = false;
+  bat_type_t  l_bat_type = sim->get_bat_type();
+  blit::Rect  l_hud( 0, 0, blit::screen.bounds.w, BRICK_TOP );
+  blit::Point l_message( blit::screen.bounds.w / 2, blit::screen.bounds.h - 45 );
+  blit::Point l_splash( blit::screen.bounds.w / 2, blit::screen.bounds.h / 2 );
+
+  /* Anything that moves is drawn however far through the next tick we are, */
+  /* so that motion is smooth whatever the frame rate.                       */
+  sim_num_t   l_fraction = sim_num_t( (int)accumulator ) / sim_num_t( SIM_TICK_MS );
+  blit::Rect  l_bat = sim->bat_render_bounds( l_fraction );
+
+  /* Work out everywhere something is going to be drawn over the background. */
+  sprites.clear();
+  sprites.add( l_bat );
+  for ( auto l_powerup : sim->get_powerups() )
+  {
+    sprites.add( blit::Rect( l_powerup->get_render_location( l_fraction ), blit::Size( 16, 8 ) ) );
+  }
+  for ( auto l_ball : sim->get_balls() )
   {
-    for ( int l_index = level->get_margin() - 1; l_index >= 0; l_index-- )
+    sprites.add( blit::Rect( l_ball->get_render_location( l_fraction ), blit::Size( 8, 8 ) ) );
+
+    /* And remember if it's stuck to the bat... */
+    if ( l_ball->stuck )
     {
-      blit::screen.alpha = 255 - ( l_index * ( 200 / level->get_margin() ) );
-      blit::screen.v_span(
-        blit::Point( l_index, 10 ), blit::screen.bounds.h - 10
-      );
-      blit::screen.v_span(
-        blit::Point( blit::screen.bounds.w - l_index, 10 ), blit::screen.bounds.h - 10
-      );
+      l_stuck_ball = true;
     }
+  }
+  BallSwarm &l_swarm = sim->get_swarm();
+  for ( uint16_t l_index = 0; l_index < l_swarm.get_count(); l_index++ )
+  {
+    sprites.add( blit::Rect( l_swarm.get_render_location( l_index, l_fraction ), blit::Size( 8, 8 ) ) );
+  }
 
-    /* Reset the alpha. */
-    blit::screen.alpha = 255;
+  /* The messages pulse and fade, so they need redrawing every frame too. */
+  l_stuck_ball = l_stuck_ball && sim->get_lives() > 0;
+  if ( l_stuck_ball )
+  {
+    sprites.add( text_bounds( assets.get_text( STR_B_TO_LAUNCH ), assets.message_font, l_message, true ) );
+  }
+  if ( splash_tween.is_running() )
+  {
+    sprites.add( text_bounds( splash_message, assets.splash_font, l_splash, false ) );
   }
 
-  /* Now we work through the level one brick at a time... */
-  for ( uint8_t l_row = 0; l_row < level->get_height(); l_row++ )
+  /* So the dirty areas are any bricks that have changed, everywhere that */
+  /* gets drawn on this frame, and everywhere that got drawn on last time. */
+  update_background();
+  dirty.add( sprites );
+  dirty.add( last_sprites );
+
+  /* The score line only changes now and then, but if anything touches it */
+  /* then it all has to be redrawn, as the text can't be drawn in pieces.  */
+  if ( sim->get_score() != drawn_score || sim->get_lives() != drawn_lives || dirty.intersects( l_hud ) )
   {
-    for ( uint8_t l_column = 0; l_column < level->get_width(); l_column++ )
-    {
-      /* Fetch the brick for this location. */
-      l_brick = level->get_brick( l_row, l_column );
+    dirty.add( l_hud );
+  }
 
-      /* Move on if it's empty. */
-      if ( l_brick == 0 )
-      {
-        continue;
-      }
+  /* Now put the background back everywhere that's dirty. */
+  for ( uint8_t l_index = 0; l_index < dirty.get_count(); l_index++ )
+  {
+    restore( dirty.get_rect( l_index ) );
+  }
 
-      /* Then draw the appropriate brick from the spritesheet. */
-      blit::screen.sprite( 
-        blit::Rect( ( l_brick - 1 ) * 4, SPRITE_ROW_BRICK, 4, 2 ),
-        blit::Point( ( l_column * 32 ) + level->get_margin(), l_row * 16 + 10 )
-      );
-    }
+  /* And draw everything on top of it. */
+  if ( dirty.intersects( l_hud ) )
+  {
+    render_hud();
   }
 
   /* Add in the bat; the position is the centre location. */
-  switch( bat_type )
+  switch( l_bat_type )
   {
     case BAT_NORMAL:  /* Simple bat, three sprites wide. */
-      blit::screen.sprite(
+      spritesheet->sprite(
+        &blit::screen,
         blit::Rect( 0, SPRITE_ROW_BAT, 3, 1 ),
-        blit::Point( bat_position - ( bat_width[bat_type] / 2 ), bat_height )
+        l_bat.tl()
       );
       break;
     case BAT_NARROW:  /* Shortened bat, two sprites wide. */
-      blit::screen.sprite(
+      spritesheet->sprite(
+        &blit::screen,
         blit::Rect( 0, SPRITE_ROW_BAT, 1, 1 ),
-        blit::Point( bat_position - ( bat_width[bat_type] / 2 ), bat_height )
+        l_bat.tl()
       );
-      blit::screen.sprite(
+      spritesheet->sprite(
+        &blit::screen,
         blit::Rect( 2, SPRITE_ROW_BAT, 1, 1 ),
-        blit::Point( bat_position - ( bat_width[bat_type] / 2 ) + 8, bat_height )
+        l_bat.tl() + blit::Point( 8, 0 )
       );
       break;
     case BAT_WIDE:  /* Stretched bat, four sprites wide. */
-      blit::screen.sprite(
+      spritesheet->sprite(
+        &blit::screen,
         blit::Rect( 0, SPRITE_ROW_BAT, 2, 1 ),
-        blit::Point( bat_position - ( bat_width[bat_type] / 2 ), bat_height )
+        l_bat.tl()
       );
-      blit::screen.sprite(
+      spritesheet->sprite(
+        &blit::screen,
         blit::Rect( 1, SPRITE_ROW_BAT, 2, 1 ),
-        blit::Point( bat_position - ( bat_width[bat_type] / 2 ) + 16, bat_height )
+        l_bat.tl() + blit::Point( 16, 0 )
       );
       break;
     case BAT_STICKY:  /* Sticky bat, three sprites wide. */
-      blit::screen.sprite(
+      spritesheet->sprite(
+        &blit::screen,
         blit::Rect( 3, SPRITE_ROW_BAT, 3, 1 ),
-        blit::Point( bat_position - ( bat_width[bat_type] / 2 ), bat_height )
+        l_bat.tl()
       );
       break;
   }
 
   /* Render the powerups, too - these go behind (before) the balls. */
-  for ( auto l_powerup : powerups )
+  for ( auto l_powerup : sim->get_powerups() )
   {
-    l_powerup->render();
+    /* This is a relatively simple sprite blit, with some positional alpha. */
+    blit::screen.alpha = l_powerup->get_render_alpha();
+    spritesheet->sprite(
+      &blit::screen,
+      blit::Rect( l_powerup->get_type() * 2, SPRITE_ROW_POWERUP, 2, 1 ),
+      l_powerup->get_render_location( l_fraction )
+    );
   }
+  blit::screen.alpha = 255;
 
   /* Balls next; we could have a number of them, in a handy container. */
-  for ( auto l_ball : balls )
+  for ( auto l_ball : sim->get_balls() )
   {
-    /* Render the ball. */
-    l_ball->render();
+    spritesheet->sprite(
+      &blit::screen,
+      blit::Rect( l_ball->get_type(), SPRITE_ROW_BALL, 1, 1 ),
+      l_ball->get_render_location( l_fraction )
+    );
+  }
 
-    /* And remember if it's stuck to the bat... */
-    if ( l_ball->stuck )
-    {
-      l_stuck_ball = true;
-    }
+  /* And any swarm from a mega multiball; they're all small balls. */
+  for ( uint16_t l_index = 0; l_index < l_swarm.get_count(); l_index++ )
+  {
+    spritesheet->sprite(
+      &blit::screen,
+      blit::Rect( BALL_SMALL, SPRITE_ROW_BALL, 1, 1 ),
+      l_swarm.get_render_location( l_index, l_fraction )
+    );
   }
 
   /* So, if we have a stuck ball, explain what the user needs to do... */
-  if ( l_stuck_ball && lives > 0 )
+  if ( l_stuck_ball )
   {
     blit::screen.pen = font_pen;
-    blit::screen.text(
+    text_cache.text(
       assets.get_text( STR_B_TO_LAUNCH ),
       assets.message_font,
-      blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 45 ),
+      l_message,
       true,
       blit::TextAlign::center_center
     );
@@ -896,15 +883,19 @@ void GameState::render( uint32_t p_time )
   {
     blit::screen.pen = font_pen;
     blit::screen.pen.a = splash_tween.value;
-    blit::screen.text(
+    text_cache.text(
       splash_message,
       assets.splash_font,
-      blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h / 2 ),
+      l_splash,
       false,
       blit::TextAlign::center_center
     );
   }
 
+  /* Next frame, everything drawn this time will need cleaning up. */
+  last_sprites = sprites;
+  dirty.clear();
+
   /* All done. */
   return;
 }
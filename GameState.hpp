@@ -12,58 +12,76 @@
 #ifndef   _GAMESTATE_HPP_
 #define   _GAMESTATE_HPP_
 
-#include <forward_list>
 #include "AssetFactory.hpp"
-#include "Ball.hpp"
+#include "Backdrop.hpp"
+#include "DirtyRects.hpp"
+#include "GameSim.hpp"
 #include "HighScore.hpp"
-#include "Level.hpp"
+#include "LevelPack.hpp"
 #include "OutputManager.hpp"
-#include "PowerUp.hpp"
+#include "Recorder.hpp"
+#include "TextCache.hpp"
 
 
-typedef enum
-{
-  BAT_NORMAL,
-  BAT_NARROW,
-  BAT_WIDE,
-  BAT_STICKY,
-  BAT_MAX
-} bat_type_t;
-
 #define FREQ_BOUNDS 96
 #define FREQ_BRICK  640
 
+/* However many things get hit in an update, there's only one buzz; the */
+/* hardest hit decides how strong it is.                                */
+#define HAPTIC_BOUNCE   0.25f
+#define HAPTIC_BREAK    0.4f
+#define HAPTIC_MS       50
+
+/* The simulation runs a tick for every 10ms that passes, however often we */
+/* get updated; if we fall a long way behind, we only try to catch up this  */
+/* many ticks, rather than get further behind trying. Each tick's physics   */
+/* is split into substeps, where there's the CPU to spare for it.           */
+#define GAMESTATE_MAX_CATCHUP     5
+#define GAMESTATE_SUBSTEPS        2
+#define GAMESTATE_PICO_SUBSTEPS   1
+
 
 class GameState : public GameStateInterface
 {
 private:
   AssetFactory               &assets = AssetFactory::get_instance();
+  Backdrop                   &backdrop = Backdrop::get_instance();
+  TextCache                  &text_cache = TextCache::get_instance();
   OutputManager              &output = OutputManager::get_instance();
   HighScore                  *high_score;
-  Level                      *level;
-  uint8_t                     lives;
+  GameSim                    *sim;
+  Recorder                   *recorder;
+  LevelPack                  *level_pack;
+  PackedImage                *spritesheet;
   blit::Pen                   font_pen;
   blit::Pen                   number_pen;
   blit::Tween                 font_tween;
   blit::Tween                 splash_tween;
   char                        splash_message[32];
-  float                       bat_position;
-  float                       bat_speed;
-  uint16_t                    bat_height;
-  bat_type_t                  bat_type;
-  uint16_t                    score;
   uint16_t                    hiscore;
-  std::forward_list<Ball*>    balls;
-  std::forward_list<PowerUp*> powerups;
-  const uint8_t               bat_width[BAT_MAX] = { 24, 16, 32, 24 };
+  bool                        clock_started;
+  uint32_t                    last_time;
+  uint32_t                    accumulator;
+  bool                        pending_launch;
+  uint8_t                    *background_data;
+  blit::Surface              *background;
+  bool                        background_valid;
+  uint16_t                    drawn_score;
+  uint8_t                     drawn_lives;
+  DirtyRects                  dirty;
+  DirtyRects                  sprites;
+  DirtyRects                  last_sprites;
 
-  void                        init( void );
-  void                        move_bat( float );
-  blit::Rect                  brick_to_screen( uint8_t, uint8_t );
-  blit::Point                 screen_to_brick( blit::Point );
-  blit::Rect                  bat_bounds( void );
-  void                        spawn_ball( bool );
-  void                        load_level( uint8_t );
+  void                        splash_level( void );
+  void                        tick( void );
+  void                        handle_event( const sim_event_t * );
+  void                        play_collisions( void );
+  void                        draw_background( blit::Surface * );
+  void                        draw_brick( uint8_t, uint8_t );
+  void                        update_background( void );
+  void                        restore( blit::Rect );
+  void                        render_hud( void );
+  blit::Rect                  text_bounds( const char *, const blit::Font &, blit::Point, bool );
 
 public:
                               GameState( void );
@@ -72,6 +90,7 @@ public:
   uint16_t                    get_score( void );
   gamestate_t                 update( uint32_t );
   void                        render( uint32_t );
+  void                        invalidate( void );
 };
 
 #endif /* _GAMESTATE_HPP_ */
@@ -16,7 +16,6 @@
 
 #include "32blit.hpp"
 #include "32blox.hpp"
-#include "assets_images.hpp"
 
 #include "HiscoreState.hpp"
 #include "HighScore.hpp"
@@ -30,12 +29,8 @@
 
 HiscoreState::HiscoreState( void )
 {
-  /* Compute the gradient colours for the background. */
-  for ( uint16_t i = 0; i < HISCORESTATE_GRADIENT_HEIGHT / 2; i++ )
-  {
-    gradient_pen[i] = gradient_pen[HISCORESTATE_GRADIENT_HEIGHT - i - 1]
-                    = blit::Pen( 10 + i, 40 - i / 2, 30 + i / 2 );
-  }
+  /* The background gradient starts from the top. */
+  gradient_offset = 0;
 
   /* And we'll need access to the high score table. */
   high_score = new HighScore();
@@ -60,6 +55,31 @@ void HiscoreState::init( GameStateInterface *p_previous )
   /* Set the font tween running. */
   font_tween.start();
 
+  /* Lay out the screen; the table is only filled in the once, here. */
+  panel.init( BACKDROP_HISCORE );
+  fill_table();
+  panel.add( &score_table );
+
+  /* The static messaging next - hi score table heading. */
+  heading_label.init(
+    assets.message_font,
+    blit::Point( blit::screen.bounds.w / 2, 10 ),
+    blit::TextAlign::top_center
+  );
+  heading_label.set_text( assets.get_text( STR_HIGH_SCORES ) );
+  heading_label.set_pen( font_pen );
+  panel.add( &heading_label );
+
+  /* Lastly, prompt the user to press a button. */
+  prompt_label.init(
+    assets.message_font,
+    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 10 ),
+    blit::TextAlign::bottom_center
+  );
+  prompt_label.set_text( assets.get_text( STR_A_TO_START ) );
+  prompt_label.set_pen( font_pen );
+  panel.add( &prompt_label );
+
   /* All done. */
   return;
 }
@@ -76,6 +96,9 @@ void HiscoreState::fini( GameStateInterface *p_next )
   /* Stop the tweens. */
   font_tween.stop();
 
+  /* And let go of the backdrop, until it's needed again. */
+  backdrop.release();
+
   /* All done. */
   return;
 }
@@ -96,13 +119,16 @@ gamestate_t HiscoreState::update( uint32_t p_time )
 
   /* In this state, we'll update the background gradient, to make it look */
   /* pretty (or at least, moving so it's obvious we haven't crashed)      */
-  if ( HISCORESTATE_GRADIENT_HEIGHT < ++gradient_offset )
+  if ( backdrop.get_period( BACKDROP_HISCORE ) <= ++gradient_offset )
   {
     gradient_offset = 0;
   }
 
   /* The font pen we use will pulse more subtlely. */
   font_pen.g = font_tween.value;
+  heading_label.set_pen( font_pen );
+  prompt_label.set_pen( font_pen );
+  panel.set_offset( gradient_offset );
 
   /* All done, remain in our current state */
   return STATE_HISCORE;
@@ -110,30 +136,26 @@ gamestate_t HiscoreState::update( uint32_t p_time )
 
 
 /*
- * render - called every frame (~20ms) to render the screen.
- * 
- * uint32_t - the elapsed time (in ms) since the game launched.
+ * fill_table - formats the top 'n' high scores, that will fit onto the screen,
+ *              into the table; each row fades a little from the one above.
  */
 
-void HiscoreState::render( uint32_t p_time )
+void HiscoreState::fill_table( void )
 {
   char l_buffer[32];
   uint8_t l_row_offset = 15;
   const hiscore_t *l_entry;
-
-  /* Clear the screen down. */
-  blit::screen.clear();
-
-  /* Draw an animated background gradient, to look pretty. */
-  for ( uint16_t i = 0; i < blit::screen.bounds.h; i++ )
-  {
-    blit::screen.pen = gradient_pen[( i + gradient_offset ) % HISCORESTATE_GRADIENT_HEIGHT];
-    blit::screen.h_span( blit::Point( 0, i ), blit::screen.bounds.w );
-  }
-
-  /* Display the top 'n' high scores, that will fit onto the screen. */
-  blit::screen.pen = blit::Pen( 255, 255, 255 );
-  for( uint8_t i = 0; i < 10; i++ )
+  blit::Pen l_pen = blit::Pen( 255, 255, 255 );
+  uint8_t i;
+
+  score_table.init(
+    assets.number_font,
+    blit::Point( blit::screen.bounds.w / 2, 45 ),
+    l_row_offset,
+    blit::TextAlign::center_center,
+    false
+  );
+  for( i = 0; i < 10; i++ )
   {
     /* Fetch the high score entry for this position. */
     l_entry = high_score->get_entry( i );
@@ -150,35 +172,41 @@ void HiscoreState::render( uint32_t p_time )
       l_entry->name,
       l_entry->score
     );
-    blit::screen.pen.b -= 15;
-    blit::screen.pen.g -= 25;
-    blit::screen.text (
-      l_buffer,
-      assets.number_font,
-      blit::Point( blit::screen.bounds.w / 2, 45 + i * l_row_offset ),
-      false,
-      blit::TextAlign::center_center
-    );
+    l_pen.b -= 15;
+    l_pen.g -= 25;
+    score_table.set_row( i, l_buffer, l_pen );
   }
+  score_table.set_row_count( i );
 
-  /* The static messaging next - hi score table heading. */
-  blit::screen.pen = font_pen;
-  blit::screen.text(
-    assets.get_text( STR_HIGH_SCORES ),
-    assets.message_font,
-    blit::Point( blit::screen.bounds.w / 2, 10 ),
-    true,
-    blit::TextAlign::top_center
-  );
+  /* All done. */
+  return;
+}
 
-  /* Lastly, prompt the user to press a button. */
-  blit::screen.text(
-    assets.get_text( STR_A_TO_START ),
-    assets.message_font,
-    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 10 ),
-    true,
-    blit::TextAlign::bottom_center
-  );
+
+/*
+ * invalidate - something else has drawn over the screen, so the panel will
+ *              need drawing again from scratch.
+ */
+
+void HiscoreState::invalidate( void )
+{
+  panel.invalidate();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * render - called every frame (~20ms) to render the screen.
+ * 
+ * uint32_t - the elapsed time (in ms) since the game launched.
+ */
+
+void HiscoreState::render( uint32_t p_time )
+{
+  /* The panel looks after the backdrop, the table and the messages. */
+  panel.render();
 
   /* All done. */
   return;
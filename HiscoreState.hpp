@@ -13,19 +13,25 @@
 #define   _HISCORESTATE_HPP_
 
 #include "AssetFactory.hpp"
+#include "Backdrop.hpp"
 #include "HighScore.hpp"
-
-#define HISCORESTATE_GRADIENT_HEIGHT 160
+#include "UI.hpp"
 
 class HiscoreState : public GameStateInterface
 {
 private:
   AssetFactory   &assets = AssetFactory::get_instance();
+  Backdrop       &backdrop = Backdrop::get_instance();
   HighScore      *high_score;
   blit::Pen       font_pen;
   blit::Tween     font_tween;
-  blit::Pen       gradient_pen[HISCORESTATE_GRADIENT_HEIGHT];
   uint8_t         gradient_offset;
+  UIPanel         panel;
+  UITable         score_table;
+  UILabel         heading_label;
+  UILabel         prompt_label;
+
+  void            fill_table( void );
 
 public:
                   HiscoreState( void );
@@ -33,6 +39,7 @@ public:
   void            fini( GameStateInterface * );
   gamestate_t     update( uint32_t );
   void            render( uint32_t );
+  void            invalidate( void );
 };
 
 #endif /* _HISCORESTATE_HPP_ */
@@ -19,107 +19,301 @@
 
 #include "32blit.hpp"
 #include "32blox.hpp"
-#include "assets_levels.hpp"
-#include "assets_pico_levels.hpp"
 
 #include "Level.hpp"
+#include "level_registry.hpp"
 
 
 /* Functions. */
 
+/*
+ * constructor - create an empty Level, for reset to load up later
+ */
+
+Level::Level( void )
+{
+  level = 0;
+  init( nullptr, 0 );
+
+  /* All done. */
+  return;
+}
+
+
 /*
  * constructor - create the Level data
  */
 
-Level::Level( uint8_t p_level, target_type_t p_target )
+Level::Level( uint16_t p_level, target_type_t p_target )
 {
-  bool l_pico = false;
+  reset( p_level, p_target );
 
-  /* Save the level number. */
-  level = p_level;
+  /* All done. */
+  return;
+}
 
-  /*
-   * The level dimensions are determined by platform, because not all screens
-   * are equal in size, or even aspect ratio.
-   */
-  switch( p_target )
+
+/*
+ * registry_fits - checks every level in the registry against the space that
+ *                 Level has for it; this is done when compiling, so there's
+ *                 no need to check again when a level is loaded.
+ */
+
+static constexpr bool registry_fits( void )
+{
+  for ( const level_set_t *l_set : a_level_registry )
   {
-    case TARGET_PICOSYSTEM: /* Need to shrink things. */
-    /* case TARGET_SDL:        /* (for testing) */
-      width = 7;
-      height = 8;
-      margin = 8;
-      l_pico = true;
-      break;
-    default:                /* In all other cases, use maximum size. */
-      width = MAX_BOARD_WIDTH;
-      height = MAX_BOARD_HEIGHT;
-      margin = 0;
-      break;
+    for ( uint8_t l_index = 0; l_index < l_set->count; l_index++ )
+    {
+      const level_info_t &l_info = l_set->levels[l_index];
+      if ( l_info.width > MAX_BOARD_WIDTH || l_info.height > MAX_BOARD_HEIGHT ||
+           l_info.length < (uint32_t)( LEVEL_HEADER_SIZE + ( l_info.width + l_info.height ) * 2 +
+                                       ( l_info.width * l_info.height + 1 ) / 2 ) )
+      {
+        return false;
+      }
+    }
   }
+  return true;
+}
+static_assert( registry_fits(), "a level in the registry doesn't fit on the board" );
+
+
+/*
+ * reset - (re)loads the level data in place, for the given level; this is
+ *         how a level is changed, so that the same Level can be used over
+ *         and over again without ever touching the heap.
+ *
+ * uint16_t      - the level number to load
+ * target_type_t - the platform we're on, which decides the level set
+ */
 
+void Level::reset( uint16_t p_level, target_type_t p_target )
+{
   /*
-   * In a normal world, we'd load a level file based on level number. But as
-   * we're embedded, level data is compiled in so we just access it.
-   *
-   * We have a seperate set of levels for pico systems.
+   * The level set is determined by platform, because not all screens are
+   * equal in size, or even aspect ratio; the registry knows which set goes
+   * with which target, and the levels themselves know their own dimensions.
+   * Levels are numbered from one, and wrap around after the last.
    */
-  switch( ( p_level % LEVEL_MAX ) )
+  const level_set_t  *l_set = a_level_registry[p_target];
+  const level_info_t &l_info = l_set->levels[( p_level + l_set->count - 1 ) % l_set->count];
+
+  /* Save the level number, and how many there are before it wraps. */
+  level = p_level;
+  level_count = l_set->count;
+
+  init( l_info.data, l_info.length );
+  return;
+}
+
+
+/*
+ * reset - (re)loads the level in place from compiled level data found
+ *         somewhere other than the registry, such as a level pack.
+ *
+ * uint16_t        - the level number being loaded
+ * const uint8_t * - the compiled level
+ * uint32_t        - the length of the compiled level
+ * uint16_t        - how many levels there are before they wrap around
+ */
+
+void Level::reset( uint16_t p_level, const uint8_t *p_data, uint32_t p_length, uint16_t p_count )
+{
+  level = p_level;
+  level_count = p_count > 0 ? p_count : 1;
+
+  init( p_data, p_length );
+  return;
+}
+
+
+/*
+ * get_level_count - returns the number of levels in a target's set.
+ *
+ * target_type_t - the platform we're on, which decides the level set
+ */
+
+uint8_t Level::get_level_count( target_type_t p_target )
+{
+  return a_level_registry[p_target]->count;
+}
+
+
+/*
+ * fits_target - checks if levels of a given shape would fit a target's
+ *               screen; that is, if they're the same shape as its own.
+ *
+ * target_type_t - the platform we're on
+ * uint8_t * 3   - the width and height in bricks, and the side margin
+ */
+
+bool Level::fits_target( target_type_t p_target, uint8_t p_width, uint8_t p_height, uint8_t p_margin )
+{
+  const level_info_t &l_info = a_level_registry[p_target]->levels[0];
+
+  return p_width == l_info.width && p_height == l_info.height && p_margin == l_info.margin;
+}
+
+
+/*
+ * read16 - fetches a little endian value out of the level data.
+ */
+
+static uint16_t read16( const uint8_t *p_data )
+{
+  return p_data[0] | ( p_data[1] << 8 );
+}
+
+
+/*
+ * is_valid - checks over compiled level data from somewhere other than the
+ *            registry, which compile_levels.py hasn't vouched for. Every
+ *            brick has to be one we know, and the counts and masks in the
+ *            header have to agree with them; init trusts them all, and a
+ *            level with the wrong brick count could never be finished.
+ *
+ * const uint8_t * - the compiled level
+ * uint32_t        - the length of the compiled level
+ *
+ * Returns a bool flag, true if the level can be loaded safely.
+ */
+
+bool Level::is_valid( const uint8_t *p_data, uint32_t p_datalength )
+{
+  uint16_t l_row_masks[MAX_BOARD_HEIGHT] = { 0 };
+  uint16_t l_column_masks[MAX_BOARD_WIDTH] = { 0 };
+  uint16_t l_breakable = 0;
+  uint16_t l_hp = 0;
+
+  /* The shape has to be one we can hold, and the data has to be all there. */
+  if ( p_data == nullptr || p_datalength < LEVEL_HEADER_SIZE || p_data[0] != LEVEL_VERSION ||
+       p_data[1] == 0 || p_data[1] > MAX_BOARD_WIDTH || p_data[2] == 0 || p_data[2] > MAX_BOARD_HEIGHT )
   {
-    case 1:
-      l_pico ? init( a_pico_level_01, a_pico_level_01_length ) : init( a_level_01, a_level_01_length );
-      break;
-    case 2:
-      l_pico ? init( a_pico_level_02, a_pico_level_02_length ) : init( a_level_02, a_level_02_length );
-      break;
-    case 3:
-      l_pico ? init( a_pico_level_03, a_pico_level_03_length ) : init( a_level_03, a_level_03_length );
-      break;
-    case 4:
-      l_pico ? init( a_pico_level_04, a_pico_level_04_length ) : init( a_level_04, a_level_04_length );
-      break;
-    case 5:
-      l_pico ? init( a_pico_level_05, a_pico_level_05_length ) : init( a_level_05, a_level_05_length );
-      break;
-    case 6:
-      l_pico ? init( a_pico_level_06, a_pico_level_06_length ) : init( a_level_06, a_level_06_length );
-      break;
-    case 7:
-      l_pico ? init( a_pico_level_07, a_pico_level_07_length ) : init( a_level_07, a_level_07_length );
-      break;
-    case 8:
-      l_pico ? init( a_pico_level_08, a_pico_level_08_length ) : init( a_level_08, a_level_08_length );
-      break;
-    case 9:
-      l_pico ? init( a_pico_level_09, a_pico_level_09_length ) : init( a_level_09, a_level_09_length );
-      break;
-    case 0:
-      l_pico ? init( a_pico_level_10, a_pico_level_10_length ) : init( a_level_10, a_level_10_length );
-      break;
-    default:
-      init( nullptr, 0 );
-      break;
+    return false;
   }
-  return;
+  uint8_t        l_width = p_data[1];
+  uint8_t        l_height = p_data[2];
+  uint32_t       l_cells = l_width * l_height;
+  const uint8_t *l_masks = p_data + LEVEL_HEADER_SIZE;
+  const uint8_t *l_bricks = l_masks + ( l_height + l_width ) * 2;
+  if ( p_datalength < LEVEL_HEADER_SIZE + ( l_height + l_width ) * 2 + ( l_cells + 1 ) / 2 )
+  {
+    return false;
+  }
+
+  /* Work out for ourselves what the header should say, from the bricks. */
+  for ( uint32_t l_cell = 0; l_cell < l_cells; l_cell++ )
+  {
+    uint8_t l_pair = l_bricks[l_cell / 2];
+    uint8_t l_brick = ( l_cell & 1 ) ? ( l_pair >> 4 ) : ( l_pair & 0x0f );
+    uint8_t l_row = l_cell / l_width;
+    uint8_t l_column = l_cell % l_width;
+
+    if ( l_brick > 8 )
+    {
+      return false;
+    }
+    if ( l_brick > 0 )
+    {
+      l_row_masks[l_row] |= 1 << l_column;
+      l_column_masks[l_column] |= 1 << l_row;
+    }
+    if ( l_brick > 0 && l_brick < 8 )
+    {
+      l_breakable++;
+      l_hp += l_brick;
+    }
+  }
+
+  /* And make sure that's what it does say. */
+  if ( read16( p_data + 4 ) != l_breakable || read16( p_data + 6 ) != l_hp )
+  {
+    return false;
+  }
+  for ( uint8_t l_row = 0; l_row < l_height; l_row++ )
+  {
+    if ( read16( l_masks + l_row * 2 ) != l_row_masks[l_row] )
+    {
+      return false;
+    }
+  }
+  for ( uint8_t l_column = 0; l_column < l_width; l_column++ )
+  {
+    if ( read16( l_masks + ( l_height + l_column ) * 2 ) != l_column_masks[l_column] )
+    {
+      return false;
+    }
+  }
+
+  /* All done. */
+  return true;
 }
 
 
 /*
- * init - reads the provided data, and loads it into our internal brick matrix
+ * init - loads a compiled level; all the counting was done when the level
+ *        was compiled, so this is just a case of copying it all in.
  *
- * uint8_t *, a single dimension array which contains an arbitrary number of rows.
- * uint32_t, the number of elements in the data.
+ * uint8_t *, the compiled level.
+ * uint32_t, the length of the compiled level.
  */
 
 void Level::init( const uint8_t *p_data, uint32_t p_datalength )
 {
-  /* Firstly, we make sure the brick matrix is empty. */
+  /* Firstly, we make sure the level is empty. */
   memset( bricks, 0, MAX_BOARD_HEIGHT * MAX_BOARD_WIDTH );
+  brick_count = 0;
+  brick_hp = 0;
+  memset( row_count, 0, MAX_BOARD_HEIGHT );
+  memset( row_mask, 0, sizeof( row_mask ) );
+  memset( column_mask, 0, sizeof( column_mask ) );
+
+  /* Anyone drawing us will need to start again from scratch. */
+  memset( changed_mask, 0, sizeof( changed_mask ) );
+  reloaded = true;
+
+  /* Make sure it's a level we understand, and that it'll fit. */
+  if ( p_data == nullptr || p_datalength < LEVEL_HEADER_SIZE || p_data[0] != LEVEL_VERSION ||
+       p_data[1] > MAX_BOARD_WIDTH || p_data[2] > MAX_BOARD_HEIGHT )
+  {
+    return;
+  }
+  uint8_t  l_width = p_data[1];
+  uint8_t  l_height = p_data[2];
+  uint32_t l_cells = l_width * l_height;
+  if ( p_datalength < LEVEL_HEADER_SIZE + ( l_height + l_width ) * 2 + ( l_cells + 1 ) / 2 )
+  {
+    return;
+  }
+
+  /* The header has the shape of the level, and the counts. */
+  width = l_width;
+  height = l_height;
+  margin = p_data[3];
+  brick_count = read16( p_data + 4 );
+  brick_hp = read16( p_data + 6 );
+  p_data += LEVEL_HEADER_SIZE;
 
-  /* Now we work through all the data we have. */
-  for( uint32_t i = 0; i < p_datalength; i++ )
+  /* Then the occupancy masks; the row counts are just the bits in them. */
+  for( uint8_t row = 0; row < height; row++, p_data += 2 )
   {
-    bricks[i / width][i % width] = p_data[i];
+    row_mask[row] = read16( p_data );
+    for ( uint16_t l_mask = row_mask[row]; l_mask != 0; l_mask &= l_mask - 1 )
+    {
+      row_count[row]++;
+    }
+  }
+  for( uint8_t col = 0; col < width; col++, p_data += 2 )
+  {
+    column_mask[col] = read16( p_data );
+  }
+
+  /* And lastly the bricks, two to a byte. */
+  for( uint32_t l_cell = 0; l_cell < l_cells; l_cell++ )
+  {
+    uint8_t l_pair = p_data[l_cell / 2];
+    bricks[l_cell / width][l_cell % width] = ( l_cell & 1 ) ? ( l_pair >> 4 ) : ( l_pair & 0x0f );
   }
 
   /* That's it, that's all we have to do. */
@@ -131,7 +325,7 @@ void Level::init( const uint8_t *p_data, uint32_t p_datalength )
  * get_level - return the level number we represent
  */
 
-uint8_t Level::get_level( void )
+uint16_t Level::get_level( void )
 {
   return level;
 }
@@ -174,23 +368,95 @@ uint8_t Level::get_margin( void )
 
 uint16_t Level::get_brick_count( void )
 {
-  uint16_t l_total = 0;
+  return brick_count;
+}
 
-  /* So, work through the bricks counting as we go. */
-  for( uint8_t row = 0; row < MAX_BOARD_HEIGHT; row++ )
-  {
-    for( uint8_t col = 0; col < MAX_BOARD_WIDTH; col++ )
-    {
-      /* We only count breakable bricks - greater than 0, less than 8. */
-      if ( bricks[row][col] > 0 && bricks[row][col] < 8 )
-      {
-        l_total++;
-      }
-    }
-  }
 
-  /* Return the count we found. */
-  return l_total;
+/*
+ * get_brick_hp - return the total number of hits needed to clear the level;
+ *                that is, the sum of all the remaining breakable bricks.
+ */
+
+uint16_t Level::get_brick_hp( void )
+{
+  return brick_hp;
+}
+
+
+/*
+ * get_row_count - return the number of bricks (of any sort) left in a row.
+ *
+ * uint8_t - the row being queried.
+ */
+
+uint8_t Level::get_row_count( uint8_t p_row )
+{
+  return row_count[p_row];
+}
+
+
+/*
+ * get_row_mask / get_column_mask - return a bitmask of the occupied cells in
+ *                                  a row (bit n is column n) or a column
+ *                                  (bit n is row n).
+ *
+ * uint8_t - the row or column being queried.
+ */
+
+uint16_t Level::get_row_mask( uint8_t p_row )
+{
+  return row_mask[p_row];
+}
+uint16_t Level::get_column_mask( uint8_t p_column )
+{
+  return column_mask[p_column];
+}
+
+
+/*
+ * get_changed_mask / is_reloaded / clear_changes - keep track of what has
+ *                                                   changed since someone last
+ *                                                   drew us; either a whole new
+ *                                                   level, or the bricks that
+ *                                                   have been hit (bit n is
+ *                                                   column n, as for row_mask).
+ *
+ * uint8_t - the row being queried.
+ */
+
+uint16_t Level::get_changed_mask( uint8_t p_row )
+{
+  return changed_mask[p_row];
+}
+bool Level::is_reloaded( void )
+{
+  return reloaded;
+}
+void Level::clear_changes( void )
+{
+  memset( changed_mask, 0, sizeof( changed_mask ) );
+  reloaded = false;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * row_occupied / column_occupied - checks for any brick at all within a span
+ *                                  of a single row or column.
+ *
+ * uint8_t - the row (or column) being queried.
+ * uint8_t * 2 - the first and last column (or row) of the span, inclusive.
+ */
+
+bool Level::row_occupied( uint8_t p_row, uint8_t p_first, uint8_t p_last )
+{
+  return ( row_mask[p_row] & ( ( 2u << p_last ) - ( 1u << p_first ) ) ) != 0;
+}
+bool Level::column_occupied( uint8_t p_column, uint8_t p_first, uint8_t p_last )
+{
+  return ( column_mask[p_column] & ( ( 2u << p_last ) - ( 1u << p_first ) ) ) != 0;
 }
 
 
@@ -234,8 +500,17 @@ uint8_t Level::hit_brick( blit::Point p_point )
     return 0;
   }
 
-  /* So, decrement the brick number. */
+  /* So, decrement the brick number, and keep the counts up to date. */
   bricks[p_point.y][p_point.x]--;
+  brick_hp--;
+  changed_mask[p_point.y] |= 1 << p_point.x;
+  if ( bricks[p_point.y][p_point.x] == 0 )
+  {
+    brick_count--;
+    row_count[p_point.y]--;
+    row_mask[p_point.y] &= ~( 1 << p_point.x );
+    column_mask[p_point.x] &= ~( 1 << p_point.y );
+  }
 
   /* And grant the player a score for each brick level destroyed. */
   return 10;
@@ -248,18 +523,36 @@ uint8_t Level::hit_brick( blit::Point p_point )
  *                  trick to increase difficulty without building load of new
  *                  levels :-)
  *
- * Returns float, the speed of the ball
+ * Returns sim_num_t, the speed of the ball
  */
 
-float Level::get_ball_speed( void )
+sim_num_t Level::get_ball_speed( void )
 {
-  float l_base_speed = 1.5f;
+  sim_num_t l_base_speed = sim_num_t( 1.5f );
 
   /* Levels are cyclic, and we have a speed bump for each complete cycle. */
-  l_base_speed += ( ( level - 1 ) / LEVEL_MAX ) / 2.0f;
+  l_base_speed += sim_num_t( ( level - 1 ) / level_count ) / sim_num_t( 2 );
 
   /* All done, return it. */
   return l_base_speed;
 }
- 
+
+
+/*
+ * hash - folds the state of the level into a running hash.
+ *
+ * uint32_t - the hash so far
+ */
+
+uint32_t Level::hash( uint32_t p_hash )
+{
+  /* Only the low byte of the level number, as it always was; that way, */
+  /* replays recorded before levels went past 255 still check out.      */
+  uint8_t l_level = level & 0xff;
+
+  p_hash = hash_fnv1a( p_hash, &l_level, sizeof( l_level ) );
+  p_hash = hash_fnv1a( p_hash, bricks, sizeof( bricks ) );
+  return p_hash;
+}
+
 /* End of Level.cpp */
@@ -11,35 +11,98 @@
 #ifndef   _LEVEL_HPP_
 #define   _LEVEL_HPP_
 
-#include "AssetFactory.hpp"
+#include "SimMath.hpp"
 
 #define   MAX_BOARD_HEIGHT  15
 #define   MAX_BOARD_WIDTH   10
 
-#define   LEVEL_MAX         10
+/* Levels are compiled by tools/compile_levels.py; a short header of the */
+/* level's shape and counts, then the bricks packed two to a byte.       */
+#define   LEVEL_VERSION     1
+#define   LEVEL_HEADER_SIZE 8
+#define   LEVEL_MAX_SIZE    ( LEVEL_HEADER_SIZE + ( MAX_BOARD_HEIGHT + MAX_BOARD_WIDTH ) * 2 + \
+                              ( MAX_BOARD_HEIGHT * MAX_BOARD_WIDTH + 1 ) / 2 )
+
+/* Occupancy is also kept as bitmasks, one bit per cell, so they need to */
+/* be wide enough for the biggest board.                                 */
+#if MAX_BOARD_WIDTH > 16 || MAX_BOARD_HEIGHT > 16
+#error "Level occupancy masks are only 16 bits wide"
+#endif
+
+/* The level registry, generated from levels.yml, is a constexpr table of   */
+/* these; every level in a set, with everything known about it up front.   */
+typedef struct
+{
+  const uint8_t        *data;
+  uint32_t              length;
+  uint8_t               width;
+  uint8_t               height;
+  uint8_t               margin;
+  uint16_t              brick_count;
+  uint16_t              brick_hp;
+} level_info_t;
+
+typedef struct
+{
+  const level_info_t   *levels;
+  uint8_t               count;
+} level_set_t;
 
 class Level
 {
 private:
-  uint8_t     level;
+  uint16_t    level;
+  uint16_t    level_count = 1;
   uint8_t     bricks[MAX_BOARD_HEIGHT][MAX_BOARD_WIDTH];
   uint8_t     width = MAX_BOARD_WIDTH;
   uint8_t     height = MAX_BOARD_HEIGHT;
   uint8_t     margin = 0;
+  uint16_t    brick_count;
+  uint16_t    brick_hp;
+  uint8_t     row_count[MAX_BOARD_HEIGHT];
+  uint16_t    row_mask[MAX_BOARD_HEIGHT];
+  uint16_t    column_mask[MAX_BOARD_WIDTH];
+  uint16_t    changed_mask[MAX_BOARD_HEIGHT];
+  bool        reloaded;
 
   void        init( const uint8_t *, uint32_t );
 
 public:
-              Level( uint8_t, target_type_t );
-  uint8_t     get_level( void );
+              Level( void );
+              Level( uint16_t, target_type_t );
+  void        reset( uint16_t, target_type_t );
+  void        reset( uint16_t, const uint8_t *, uint32_t, uint16_t );
+  static uint8_t get_level_count( target_type_t );
+  static bool fits_target( target_type_t, uint8_t, uint8_t, uint8_t );
+  static bool is_valid( const uint8_t *, uint32_t );
+  uint16_t    get_level( void );
   uint8_t     get_width( void );
   uint8_t     get_height( void );
   uint8_t     get_margin( void );
   uint16_t    get_brick_count( void );
+  uint16_t    get_brick_hp( void );
+  uint8_t     get_row_count( uint8_t );
+  uint16_t    get_row_mask( uint8_t );
+  uint16_t    get_column_mask( uint8_t );
+  uint16_t    get_changed_mask( uint8_t );
+  bool        is_reloaded( void );
+  void        clear_changes( void );
+  bool        row_occupied( uint8_t, uint8_t, uint8_t );
+  bool        column_occupied( uint8_t, uint8_t, uint8_t );
   uint8_t     get_brick( uint8_t, uint8_t );
   uint8_t     get_brick( blit::Point );
   uint8_t     hit_brick( blit::Point );
-  float       get_ball_speed( void );
+  sim_num_t   get_ball_speed( void );
+  uint32_t    hash( uint32_t );
+};
+
+/* Somewhere other than the built-in levels that levels can come from; if */
+/* it can't provide a level, the built-in one is used instead.            */
+class LevelSource
+{
+public:
+  virtual    ~LevelSource( void ) {}
+  virtual bool load( uint16_t, Level & ) = 0;
 };
 
 #endif /* _LEVEL_HPP_ */
@@ -0,0 +1,216 @@
+/*
+ * LevelPack.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * Level packs are written by tools/compile_levels.py, and read through the
+ * blit file API. Nothing but the header is read when a pack is opened; each
+ * level is read as it's needed, straight into a buffer big enough for any
+ * one level, so a pack can hold thousands of them at no extra cost.
+ *
+ * Everything is stored little-endian. The header is:
+ *
+ *   0  char[4]  magic ("32BP")
+ *   4  uint8_t  pack format version
+ *   5  uint8_t  level format version (LEVEL_VERSION)
+ *   6  uint8_t  level width, in bricks
+ *   7  uint8_t  level height, in bricks
+ *   8  uint8_t  side margin, in pixels
+ *   9  uint8_t  (reserved)
+ *  10  uint16_t number of levels
+ *
+ * It's followed by an index, with one six byte entry per level:
+ *
+ *   0  uint32_t offset of the level, from the start of the file
+ *   4  uint16_t length of the level
+ *
+ * And then by the levels themselves, compiled exactly as the built-in ones.
+ */
+
+/* System headers. */
+
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "LevelPack.hpp"
+
+
+/* Functions. */
+
+/*
+ * constructor - nothing is open until we're asked to open something.
+ */
+
+LevelPack::LevelPack( void )
+{
+  level_count = 0;
+  width = 0;
+  height = 0;
+  margin = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * destructor - makes sure the file is closed.
+ */
+
+LevelPack::~LevelPack( void )
+{
+  close();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * open - opens a level pack, and checks that its levels will fit on the
+ *        screen we're playing on. Any pack already open is closed first.
+ *
+ * const char *  - the name of the pack file
+ * target_type_t - the platform we're on
+ *
+ * Returns a bool flag, true if the pack is open and ready to use.
+ */
+
+bool LevelPack::open( const char *p_filename, target_type_t p_target )
+{
+  uint8_t l_header[LEVELPACK_HEADER_SIZE];
+
+  /* Finish off anything we already had open. */
+  close();
+
+  /* Open the file, and read in the header. */
+  if ( !blit::file_exists( p_filename ) || !file.open( p_filename, blit::OpenMode::read ) )
+  {
+    return false;
+  }
+  if ( file.read( 0, LEVELPACK_HEADER_SIZE, (char *)l_header ) != LEVELPACK_HEADER_SIZE ||
+       memcmp( l_header, LEVELPACK_MAGIC, 4 ) != 0 || l_header[4] != LEVELPACK_VERSION ||
+       l_header[5] != LEVEL_VERSION )
+  {
+    close();
+    return false;
+  }
+
+  /* The levels have to be the same shape as our own, or they won't fit. */
+  width = l_header[6];
+  height = l_header[7];
+  margin = l_header[8];
+  level_count = l_header[10] | ( l_header[11] << 8 );
+  if ( level_count == 0 || !Level::fits_target( p_target, width, height, margin ) ||
+       file.get_length() < LEVELPACK_HEADER_SIZE + (uint32_t)level_count * LEVELPACK_ENTRY_SIZE )
+  {
+    close();
+    return false;
+  }
+
+  /* All done. */
+  return true;
+}
+
+
+/*
+ * close - closes the pack, if it's open.
+ */
+
+void LevelPack::close( void )
+{
+  if ( file.is_open() )
+  {
+    file.close();
+  }
+  level_count = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * is_open - checks if there's a pack open to load levels from.
+ */
+
+bool LevelPack::is_open( void )
+{
+  return level_count > 0;
+}
+
+
+/*
+ * get_level_count - returns the number of levels in the pack.
+ */
+
+uint16_t LevelPack::get_level_count( void )
+{
+  return level_count;
+}
+
+
+/*
+ * load - loads a level from the pack; its index entry tells us where it is,
+ *        so it's two small reads whichever level it is. Levels are numbered
+ *        from one, and wrap around after the last.
+ *
+ * uint16_t - the level number to load
+ * Level &  - the level to load it into
+ *
+ * Returns a bool flag, false if the level couldn't be read, or doesn't check out.
+ */
+
+bool LevelPack::load( uint16_t p_level, Level &p_target )
+{
+  uint8_t  l_entry[LEVELPACK_ENTRY_SIZE];
+  uint16_t l_index;
+  uint32_t l_offset;
+  uint16_t l_length;
+
+  /* Nothing to load if there's no pack. */
+  if ( level_count == 0 )
+  {
+    return false;
+  }
+
+  /* Find the level in the index. */
+  l_index = ( p_level + level_count - 1 ) % level_count;
+  if ( file.read( LEVELPACK_HEADER_SIZE + (uint32_t)l_index * LEVELPACK_ENTRY_SIZE,
+                  LEVELPACK_ENTRY_SIZE, (char *)l_entry ) != LEVELPACK_ENTRY_SIZE )
+  {
+    return false;
+  }
+  l_offset = l_entry[0] | ( l_entry[1] << 8 ) | ( l_entry[2] << 16 ) | ( (uint32_t)l_entry[3] << 24 );
+  l_length = l_entry[4] | ( l_entry[5] << 8 );
+
+  /* And read it in, making sure it's the level the pack says it is. */
+  if ( l_length < LEVEL_HEADER_SIZE + ( width + height ) * 2 + ( width * height + 1 ) / 2 ||
+       l_length > LEVEL_MAX_SIZE ||
+       file.read( l_offset, l_length, (char *)buffer ) != l_length ||
+       buffer[0] != LEVEL_VERSION || buffer[1] != width || buffer[2] != height || buffer[3] != margin )
+  {
+    return false;
+  }
+
+  /* The pack could have been damaged, or edited by hand, since it was */
+  /* compiled; so check the level over before the Level trusts it.     */
+  if ( !Level::is_valid( buffer, l_length ) )
+  {
+    return false;
+  }
+
+  /* Which is all the Level needs to know. */
+  p_target.reset( p_level, buffer, l_length, level_count );
+  return true;
+}
+
+
+/* End of LevelPack.cpp */
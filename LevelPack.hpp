@@ -0,0 +1,45 @@
+/*
+ * LevelPack.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * A LevelPack is a file full of levels, from the SD card or the desktop; a
+ * whole new campaign, without building a new game. Only one level is ever
+ * read from it at a time, however many levels are in it.
+ */
+
+#ifndef   _LEVELPACK_HPP_
+#define   _LEVELPACK_HPP_
+
+#include "Level.hpp"
+
+#define LEVELPACK_MAGIC         "32BP"
+#define LEVELPACK_VERSION       1
+#define LEVELPACK_HEADER_SIZE   12
+#define LEVELPACK_ENTRY_SIZE    6
+
+class LevelPack : public LevelSource
+{
+private:
+  blit::File      file;
+  uint16_t        level_count;
+  uint8_t         width;
+  uint8_t         height;
+  uint8_t         margin;
+  uint8_t         buffer[LEVEL_MAX_SIZE];
+
+public:
+                  LevelPack( void );
+                 ~LevelPack( void );
+  bool            open( const char *, target_type_t );
+  void            close( void );
+  bool            is_open( void );
+  uint16_t        get_level_count( void );
+  bool            load( uint16_t, Level & );
+};
+
+#endif /* _LEVELPACK_HPP_ */
+
+/* End of LevelPack.hpp */
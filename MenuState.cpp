@@ -21,7 +21,6 @@
 
 #include "32blit.hpp"
 #include "32blox.hpp"
-#include "assets_images.hpp"
 
 #include "MenuState.hpp"
 
@@ -34,12 +33,8 @@
 
 MenuState::MenuState( void )
 {
-  /* And compute the gradient colours for the background. */
-  for ( uint16_t i = 0; i < MENUSTATE_GRADIENT_HEIGHT / 2; i++ )
-  {
-    gradient_pen[i] = gradient_pen[MENUSTATE_GRADIENT_HEIGHT - i - 1]
-                    = blit::Pen( 40 - i / 2, 10 + i, 30 + i / 2 );
-  }
+  /* The background gradient starts from the top. */
+  gradient_offset = 0;
 
   /* The font pen will be simpler. */
   plain_pen = blit::Pen( 255, 255, 0 );
@@ -65,6 +60,57 @@ void MenuState::init( GameStateInterface *p_previous )
   /* And set the cursor to the first option. */
   cursor = 0;
 
+  /* Lay out the menu; the logo in the middle, and the options below it. */
+  uint16_t l_left = ( blit::screen.bounds.w - menu_size.w ) / 2;
+  uint16_t l_middle = blit::screen.bounds.w / 2;
+
+  PackedImage *l_logo = assets.acquire( ASSET_LONG_LOGO );
+
+  panel.init( BACKDROP_TITLE );
+  logo.init( l_logo, blit::Point( ( blit::screen.bounds.w - l_logo->get_bounds().w ) / 2, 10 ) );
+  panel.add( &logo );
+
+  sound_toggle.init(
+    assets.message_font, assets.get_text( STR_MENU_SOUND ),
+    blit::Point( l_left, 90 ), blit::Point( l_middle, 90 ),
+    assets.get_text( STR_MENU_ON ), assets.get_text( STR_MENU_OFF )
+  );
+  panel.add( &sound_toggle );
+  music_toggle.init(
+    assets.message_font, assets.get_text( STR_MENU_MUSIC ),
+    blit::Point( l_left, 115 ), blit::Point( l_middle, 115 ),
+    assets.get_text( STR_MENU_ON ), assets.get_text( STR_MENU_OFF )
+  );
+  panel.add( &music_toggle );
+  haptic_toggle.init(
+    assets.message_font, assets.get_text( STR_MENU_HAPTIC ),
+    blit::Point( l_left, 140 ), blit::Point( l_middle, 140 ),
+    assets.get_text( STR_MENU_ON ), assets.get_text( STR_MENU_OFF )
+  );
+  panel.add( &haptic_toggle );
+  mega_toggle.init(
+    assets.message_font, assets.get_text( STR_MENU_MEGA ),
+    blit::Point( l_left, 165 ), blit::Point( l_middle, 165 ),
+    assets.get_text( STR_MENU_ON ), assets.get_text( STR_MENU_OFF )
+  );
+  panel.add( &mega_toggle );
+
+  exit_label.init( assets.number_font, blit::Point( l_middle, 200 ), blit::TextAlign::bottom_center );
+  exit_label.set_text( assets.get_text( STR_MENU_TO_EXIT ) );
+  exit_label.set_pen( plain_pen );
+  panel.add( &exit_label );
+
+  /* Lastly some gratuitous self-promotion. */
+  url_label.init(
+    assets.number_font,
+    blit::Point( l_middle, blit::screen.bounds.h - 10 ),
+    blit::TextAlign::bottom_center
+  );
+  url_label.set_text( assets.get_text( STR_MENU_URL ) );
+  url_label.set_pen( plain_pen );
+  panel.add( &url_label );
+  update_widgets();
+
   /* All done. */
   return;
 }
@@ -81,11 +127,41 @@ void MenuState::fini( GameStateInterface *p_next )
   /* Stop the tweens. */
   font_tween.stop();
 
+  /* And let go of the backdrop and logo, until they're needed again. */
+  backdrop.release();
+  assets.release( ASSET_LONG_LOGO );
+
   /* And we're done. */
   return;
 }
 
 
+/*
+ * update_widgets - brings the options up to date with the current settings,
+ *                  cursor and pulsing pen.
+ */
+
+void MenuState::update_widgets( void )
+{
+  panel.set_offset( gradient_offset );
+  sound_toggle.set_state( output.sound_enabled() );
+  sound_toggle.set_focus( cursor == 0 );
+  sound_toggle.set_pens( plain_pen, font_pen );
+  music_toggle.set_state( output.music_enabled() );
+  music_toggle.set_focus( cursor == 1 );
+  music_toggle.set_pens( plain_pen, font_pen );
+  haptic_toggle.set_state( output.haptic_enabled() );
+  haptic_toggle.set_focus( cursor == 2 );
+  haptic_toggle.set_pens( plain_pen, font_pen );
+  mega_toggle.set_state( output.mega_multiball_enabled() );
+  mega_toggle.set_focus( cursor == 3 );
+  mega_toggle.set_pens( plain_pen, font_pen );
+
+  /* All done. */
+  return;
+}
+
+
 /*
  * update - called every tick (~10ms) to update the state of the game.
  * 
@@ -96,7 +172,7 @@ gamestate_t MenuState::update( uint32_t p_time )
 {
   /* In this state, we'll update the background gradient, to make it look */
   /* pretty (or at least, moving so it's obvious we haven't crashed)      */
-  if ( MENUSTATE_GRADIENT_HEIGHT < ++gradient_offset )
+  if ( backdrop.get_period( BACKDROP_TITLE ) <= ++gradient_offset )
   {
     gradient_offset = 0;
   }
@@ -120,7 +196,7 @@ gamestate_t MenuState::update( uint32_t p_time )
     blit::vibration = 0.25f;
     cursor--;
   }
-  if ( ( blit::buttons.pressed & blit::Button::DPAD_DOWN ) && ( cursor < 2 ) )
+  if ( ( blit::buttons.pressed & blit::Button::DPAD_DOWN ) && ( cursor < 3 ) )
   {
     blit::vibration = 0.25f;
     cursor++;
@@ -142,11 +218,17 @@ gamestate_t MenuState::update( uint32_t p_time )
       case 2:       /* Haptic. */
         output.enable_haptic( !output.haptic_enabled() );
         break;
+      case 3:       /* Mega multiball. */
+        output.enable_mega_multiball( !output.mega_multiball_enabled() );
+        break;
       default:      /* Should never be reached. */
         break;
     }
   }
 
+  /* Bring the widgets up to date; they'll work out if anything's changed. */
+  update_widgets();
+
   /* For this state, the return value is meaningless. */
   return STATE_NONE;
 }
@@ -160,117 +242,8 @@ gamestate_t MenuState::update( uint32_t p_time )
 
 void MenuState::render( uint32_t p_time )
 {
-  const char *l_charptr;
-
-  /* Clear the screen down. */
-  blit::screen.clear();
-
-  /* Draw an animated background gradient, to look pretty. */
-  for ( uint16_t i = 0; i < blit::screen.bounds.h; i++ )
-  {
-    blit::screen.pen = gradient_pen[( i + gradient_offset ) % MENUSTATE_GRADIENT_HEIGHT];
-    blit::screen.h_span( blit::Point( 0, i ), blit::screen.bounds.w );
-  }
-
-  /* Place the logo in the middle of the screen. */
-  blit::Point l_pos;
-  l_pos.x = (blit::screen.bounds.w - assets.surface_long_logo->bounds.w) / 2;
-  l_pos.y = 10;
-  blit::screen.blit( assets.surface_long_logo, assets.surface_long_logo->clip, l_pos );
-
-  /* Now render all our menu options, highlighting what we're currently on. */
-  blit::screen.pen = plain_pen;
-  blit::screen.text(
-    assets.get_text( STR_MENU_SOUND ),
-    assets.message_font,
-    blit::Point( ( blit::screen.bounds.w - menu_size.w ) / 2, 100 ),
-    true,
-    blit::TextAlign::center_left
-  );
-  if ( output.sound_enabled() )
-  {
-    l_charptr = assets.get_text( STR_MENU_ON );
-  }
-  else
-  {
-    l_charptr = assets.get_text( STR_MENU_OFF );
-  }
-  blit::screen.pen = ( cursor == 0 ) ? font_pen : plain_pen;
-  blit::screen.text(
-    l_charptr,
-    assets.message_font,
-    blit::Point( blit::screen.bounds.w / 2, 100 ),
-    true,
-    blit::TextAlign::center_left
-  );
-
-  blit::screen.pen = plain_pen;
-  blit::screen.text(
-    assets.get_text( STR_MENU_MUSIC ),
-    assets.message_font,
-    blit::Point( ( blit::screen.bounds.w - menu_size.w ) / 2, 130 ),
-    true,
-    blit::TextAlign::center_left
-  );
-  if ( output.music_enabled() )
-  {
-    l_charptr = assets.get_text( STR_MENU_ON );
-  }
-  else
-  {
-    l_charptr = assets.get_text( STR_MENU_OFF );
-  }
-  blit::screen.pen = ( cursor == 1 ) ? font_pen : plain_pen;
-  blit::screen.text(
-    l_charptr,
-    assets.message_font,
-    blit::Point( blit::screen.bounds.w / 2, 130 ),
-    true,
-    blit::TextAlign::center_left
-  );
-
-  blit::screen.pen = plain_pen;
-  blit::screen.text(
-    assets.get_text( STR_MENU_HAPTIC ),
-    assets.message_font,
-    blit::Point( ( blit::screen.bounds.w - menu_size.w ) / 2, 160 ),
-    true,
-    blit::TextAlign::center_left
-  );
-  if ( output.haptic_enabled() )
-  {
-    l_charptr = assets.get_text( STR_MENU_ON );
-  }
-  else
-  {
-    l_charptr = assets.get_text( STR_MENU_OFF );
-  }
-  blit::screen.pen = ( cursor == 2 ) ? font_pen : plain_pen;
-  blit::screen.text(
-    l_charptr,
-    assets.message_font,
-    blit::Point( blit::screen.bounds.w / 2, 160 ),
-    true,
-    blit::TextAlign::center_left
-  );
-
-  blit::screen.pen = plain_pen;
-  blit::screen.text(
-    assets.get_text( STR_MENU_TO_EXIT ),
-    assets.number_font,
-    blit::Point( blit::screen.bounds.w / 2, 200 ),
-    true,
-    blit::TextAlign::bottom_center
-  );
-
-  /* Lastly some gratuitous self-promotion. */
-  blit::screen.text(
-    assets.get_text( STR_MENU_URL ),
-    assets.number_font,
-    blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 10 ),
-    true,
-    blit::TextAlign::bottom_center
-  );
+  /* The panel looks after the backdrop and all the options. */
+  panel.render();
 
   /* All done. */
   return;
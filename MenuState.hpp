@@ -13,22 +13,32 @@
 #define   _MENUSTATE_HPP_
 
 #include "AssetFactory.hpp"
+#include "Backdrop.hpp"
 #include "OutputManager.hpp"
-
-#define MENUSTATE_GRADIENT_HEIGHT 160
+#include "UI.hpp"
 
 class MenuState : public GameStateInterface
 {
 private:
   AssetFactory   &assets = AssetFactory::get_instance();
+  Backdrop       &backdrop = Backdrop::get_instance();
   OutputManager  &output = OutputManager::get_instance();
   blit::Pen       font_pen;
   blit::Pen       plain_pen;
   blit::Tween     font_tween;
-  blit::Pen       gradient_pen[MENUSTATE_GRADIENT_HEIGHT];
   uint8_t         gradient_offset;
   blit::Size      menu_size;
   uint8_t         cursor;
+  UIPanel         panel;
+  UIImage         logo;
+  UIToggle        sound_toggle;
+  UIToggle        music_toggle;
+  UIToggle        haptic_toggle;
+  UIToggle        mega_toggle;
+  UILabel         exit_label;
+  UILabel         url_label;
+
+  void            update_widgets( void );
 
 public:
                   MenuState( void );
@@ -0,0 +1,157 @@
+/*
+ * Messages.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The Messages hold all the text used in the game, for every language and
+ * platform. They live apart from the AssetFactory so that the headless tools
+ * can get at them without dragging in the rest of the blit runtime.
+ */
+
+/* System headers. */
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "Messages.hpp"
+
+
+/* Functions. */
+
+/*
+ * get_message - fetches the correct text to use for a given message, based
+ *               both on the language and whether we're on a physical Blit,
+ *               or emulated on a desktop.
+ *
+ * str_lang_t    - the language to use
+ * target_type_t - the platform we're running on
+ * str_message_t - the message required
+ */
+
+const char *get_message( str_lang_t p_language, target_type_t p_target, str_message_t p_message )
+{
+  const char *l_text = "undefined";
+
+  /* Choose between languages, and then messages. */
+  switch( p_language )
+  {
+    case LANG_EN:        /* English */
+      switch( p_message )
+      {
+        case STR_A_TO_START:
+          if ( TARGET_32BLIT == p_target )
+            l_text = "PRESS 'A' TO START";
+          else if ( TARGET_PICOSYSTEM == p_target )
+            l_text = "'A' TO START";
+          else
+            l_text = "PRESS 'Z' TO START";
+          break;
+        case STR_B_TO_LAUNCH:
+          if ( TARGET_32BLIT == p_target )
+            l_text = "PRESS 'B' TO LAUNCH";
+          else if ( TARGET_PICOSYSTEM == p_target )
+            l_text = "'B' TO LAUNCH";
+          else
+            l_text = "PRESS 'X' TO LAUNCH";
+          break;
+        case STR_B_TO_SAVE:
+          if ( TARGET_32BLIT == p_target )
+            l_text = "PRESS 'B' TO SAVE";
+          else if ( TARGET_PICOSYSTEM == p_target )
+            l_text = "'B' TO SAVE";
+          else
+            l_text = "PRESS 'X' TO SAVE";
+          break;
+        case STR_MENU_TO_EXIT:
+          if ( TARGET_32BLIT == p_target )
+            l_text = "PRESS <MENU> TO EXIT";
+          else
+            l_text = "PRESS '2' TO EXIT";
+          break;
+
+        case STR_LANG_EN:
+          l_text = "English";
+          break;
+        case STR_NEW_HIGH_SCORE:
+          l_text = "NEW HIGH SCORE!";
+          break;
+        case STR_LEFT_RIGHT_SELECT:
+          l_text = "LEFT/RIGHT TO SELECT";
+          break;
+        case STR_UP_DOWN_CHANGE:
+          l_text = "UP/DOWN TO CHANGE";
+          break;
+        case STR_LEVEL:
+          l_text = "LEVEL";
+          break;
+        case STR_POWERUP_SPEED:
+          l_text = "SPEED\nUP!";
+          break;
+        case STR_POWERUP_SLOW:
+          l_text = "SLOW\nDOWN";
+          break;
+        case STR_POWERUP_STICKY:
+          l_text = "STICKY\nBAT!";
+          break;
+        case STR_POWERUP_GROW:
+          l_text = "GROW\nBAT!";
+          break;
+        case STR_POWERUP_SHRINK:
+          l_text = "SHRINK\nBAT!";
+          break;
+        case STR_POWERUP_MULTI:
+          l_text = "MULTI\nBALL";
+          break;
+        case STR_POWERUP_EXTRA:
+          l_text = "EXTRA\nLIFE";
+          break;
+        case STR_GAME_OVER:
+          l_text = "GAME\nOVER";
+          break;
+        case STR_BALL_LOST:
+          l_text = "BALL\nLOST";
+          break;
+        case STR_SCORE:
+          l_text = "SCORE";
+          break;
+        case STR_HISCORE:
+          l_text = "HI";
+          break;
+        case STR_HIGH_SCORES:
+          l_text = "HIGH SCORES";
+          break;
+        case STR_MENU_SOUND:
+          l_text = "Sound";
+          break;
+        case STR_MENU_MUSIC:
+          l_text = "Music";
+          break;
+        case STR_MENU_HAPTIC:
+          l_text = "Haptic";
+          break;
+        case STR_MENU_MEGA:
+          l_text = "Mega";
+          break;
+        case STR_MENU_ON:
+          l_text = "  <ON>";
+          break;
+        case STR_MENU_OFF:
+          l_text = " <OFF>";
+          break;
+        case STR_MENU_URL:
+        l_text = "VISIT US AT https://blithub.co.uk";
+          break;
+      }
+  }
+
+  /* Return the match. */
+  return l_text;
+}
+
+
+/* End of Messages.cpp */
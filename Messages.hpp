@@ -0,0 +1,58 @@
+/*
+ * Messages.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The Messages hold all the text used in the game, for every language and
+ * platform.
+ */
+
+#ifndef   _MESSAGES_HPP_
+#define   _MESSAGES_HPP_
+
+/* All text is now output via the Asset Factory, so we can switch for both */
+/* platform and language options.                                          */
+typedef enum
+{
+  LANG_EN
+} str_lang_t;
+
+typedef enum
+{
+  STR_LANG_EN = LANG_EN,
+  STR_A_TO_START,
+  STR_B_TO_LAUNCH,
+  STR_B_TO_SAVE,
+  STR_MENU_TO_EXIT,
+  STR_NEW_HIGH_SCORE,
+  STR_LEFT_RIGHT_SELECT,
+  STR_UP_DOWN_CHANGE,
+  STR_LEVEL,
+  STR_POWERUP_SPEED,
+  STR_POWERUP_SLOW,
+  STR_POWERUP_STICKY,
+  STR_POWERUP_GROW,
+  STR_POWERUP_SHRINK,
+  STR_POWERUP_MULTI,
+  STR_POWERUP_EXTRA,
+  STR_GAME_OVER,
+  STR_BALL_LOST,
+  STR_SCORE,
+  STR_HISCORE,
+  STR_HIGH_SCORES,
+  STR_MENU_SOUND,
+  STR_MENU_MUSIC,
+  STR_MENU_HAPTIC,
+  STR_MENU_MEGA,
+  STR_MENU_ON,
+  STR_MENU_OFF,
+  STR_MENU_URL
+} str_message_t;
+
+const char *get_message( str_lang_t, target_type_t, str_message_t );
+
+#endif /* _MESSAGES_HPP_ */
+
+/* End of Messages.hpp */
@@ -7,7 +7,8 @@
  *
  * The OutputManager is a singleton class to manage outputs; the options as to
  * which output channels are enabled are saved, so that we always remember if
- * we should be playing music, sounds or haptics.
+ * we should be playing music, sounds or haptics. The one game option on the
+ * menu, mega multiball, is saved alongside them.
  */
 
 /* System headers. */
@@ -37,6 +38,7 @@ OutputManager::OutputManager( void )
     flags.sound_enabled = true;
     flags.music_enabled = true;
     flags.haptic_enabled = false;
+    flags.mega_multiball = false;
   }
 
   /* Set up the sound channels. */
@@ -103,6 +105,10 @@ bool OutputManager::haptic_enabled( void )
 {
   return flags.haptic_enabled;
 }
+bool OutputManager::mega_multiball_enabled( void )
+{
+  return flags.mega_multiball;
+}
 
 
 /*
@@ -147,6 +153,13 @@ void OutputManager::enable_haptic( bool p_flag )
   blit::write_save( flags, SAVE_SLOT_OUTPUT );
   return;
 }
+void OutputManager::enable_mega_multiball( bool p_flag )
+{
+  /* This is a rule of the game, so it's only picked up by the next one. */
+  flags.mega_multiball = p_flag;
+  blit::write_save( flags, SAVE_SLOT_OUTPUT );
+  return;
+}
 
 
 /*
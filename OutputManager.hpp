@@ -18,6 +18,7 @@ typedef struct
   bool                  sound_enabled;
   bool                  music_enabled;
   bool                  haptic_enabled;  
+  bool                  mega_multiball;
 } output_flags_t;
 
 #define CHANNEL_MUSIC   0
@@ -40,9 +41,11 @@ public:
   bool                  sound_enabled( void );
   bool                  music_enabled( void );
   bool                  haptic_enabled( void );
+  bool                  mega_multiball_enabled( void );
   void                  enable_sound( bool );
   void                  enable_music( bool );
   void                  enable_haptic( bool );
+  void                  enable_mega_multiball( bool );
   void                  update( uint32_t );
   void                  trigger_haptic( float, uint32_t );
   void                  play_effect_bounce( uint16_t );
@@ -0,0 +1,328 @@
+/*
+ * PackedImage.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * A PackedImage is an image left in the palettized, run length encoded form
+ * that tools/pack_images.py produces. Nothing is unpacked up front; whenever
+ * something is drawn, just the bands of lines it covers are unpacked, into a
+ * small cache which throws out the least recently used band to make room.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <new>
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "PackedImage.hpp"
+
+
+/* Functions. */
+
+/*
+ * read16 / read32 - fetch little endian values out of the packed data.
+ */
+
+static uint16_t read16( const uint8_t *p_data )
+{
+  return p_data[0] | ( p_data[1] << 8 );
+}
+static uint32_t read32( const uint8_t *p_data )
+{
+  return p_data[0] | ( p_data[1] << 8 ) | ( p_data[2] << 16 ) | ( (uint32_t)p_data[3] << 24 );
+}
+
+
+/*
+ * constructor - reads the header of the packed image, and sets up the cache;
+ *               no band is unpacked until it's first drawn from.
+ *
+ * const uint8_t * - the packed image
+ * uint16_t        - how many bands to keep unpacked at once; 0 for all of them
+ */
+
+PackedImage::PackedImage( const uint8_t *p_data, uint16_t p_cache_bands )
+{
+  uint16_t l_entries;
+
+  /* The header tells us the shape of the image. */
+  bounds = blit::Size( read16( p_data ), read16( p_data + 2 ) );
+  band_height = p_data[4];
+  band_count = ( bounds.h + band_height - 1 ) / band_height;
+  l_entries = p_data[5] + 1;
+
+  /* Followed by the palette, which every band shares. */
+  palette = new blit::Pen[l_entries];
+  for ( uint16_t l_index = 0; l_index < l_entries; l_index++ )
+  {
+    const uint8_t *l_colour = p_data + 6 + l_index * 4;
+    palette[l_index] = blit::Pen( l_colour[0], l_colour[1], l_colour[2], l_colour[3] );
+  }
+
+  /* And then where each band starts, and the bands themselves. */
+  offsets = p_data + 6 + l_entries * 4;
+  stream = offsets + ( band_count + 1 ) * 4;
+
+  /* The cache starts off empty; the memory is found as it's needed. */
+  cache_size = band_count;
+  if ( p_cache_bands > 0 && p_cache_bands < band_count )
+  {
+    cache_size = p_cache_bands;
+  }
+  cache = new packed_band_t[cache_size];
+  for ( uint16_t l_index = 0; l_index < cache_size; l_index++ )
+  {
+    cache[l_index].band = band_count;
+    cache[l_index].last_used = 0;
+    cache[l_index].data = nullptr;
+    cache[l_index].surface = nullptr;
+  }
+  clock = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * destructor - frees up the cache, and the palette.
+ */
+
+PackedImage::~PackedImage( void )
+{
+  flush();
+  delete[] cache;
+  delete[] palette;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * unpack - decodes a single band of the image.
+ *
+ * uint16_t  - the band to unpack
+ * uint8_t * - where to unpack it to; it must be big enough for a whole band
+ *
+ * Returns true if it unpacked cleanly.
+ */
+
+bool PackedImage::unpack( uint16_t p_band, uint8_t *p_target )
+{
+  const uint8_t *l_packet = stream + read32( offsets + p_band * 4 );
+  const uint8_t *l_end = stream + read32( offsets + ( p_band + 1 ) * 4 );
+  uint16_t       l_lines = std::min( (int32_t)band_height, bounds.h - p_band * band_height );
+  uint32_t       l_total = l_lines * bounds.w;
+  uint32_t       l_count = 0;
+
+  while( l_packet < l_end && l_count < l_total )
+  {
+    uint8_t  l_control = *l_packet++;
+    uint32_t l_length;
+
+    /* Under 128 is a run of literal indices... */
+    if ( l_control < 128 )
+    {
+      l_length = l_control + 1;
+      if ( l_packet + l_length > l_end || l_count + l_length > l_total )
+      {
+        return false;
+      }
+      memcpy( p_target + l_count, l_packet, l_length );
+      l_packet += l_length;
+    }
+    /* ...and anything else is one index, repeated. */
+    else
+    {
+      l_length = l_control - 126;
+      if ( l_packet >= l_end || l_count + l_length > l_total )
+      {
+        return false;
+      }
+      memset( p_target + l_count, *l_packet++, l_length );
+    }
+    l_count += l_length;
+  }
+
+  return l_count == l_total;
+}
+
+
+/*
+ * fetch - finds a band in the cache, unpacking it into the least recently
+ *         used slot if it isn't there already.
+ *
+ * uint16_t - the band required
+ *
+ * Returns a surface holding the band, or nullptr if it couldn't be unpacked.
+ */
+
+blit::Surface *PackedImage::fetch( uint16_t p_band )
+{
+  packed_band_t *l_slot = nullptr;
+  packed_band_t *l_spare = nullptr;
+
+  /* Look for the band, and the best slot to put it in if it isn't there. */
+  for ( uint16_t l_index = 0; l_index < cache_size; l_index++ )
+  {
+    if ( cache[l_index].band == p_band )
+    {
+      cache[l_index].last_used = ++clock;
+      return cache[l_index].surface;
+    }
+    if ( l_slot == nullptr || cache[l_index].last_used < l_slot->last_used )
+    {
+      l_slot = &cache[l_index];
+    }
+    if ( cache[l_index].data != nullptr &&
+         ( l_spare == nullptr || cache[l_index].last_used < l_spare->last_used ) )
+    {
+      l_spare = &cache[l_index];
+    }
+  }
+
+  /* A slot that's never been used needs the memory for it; if there isn't */
+  /* enough, we'll have to make do with one of the slots we've already got. */
+  if ( l_slot->data == nullptr )
+  {
+    l_slot->data = new( std::nothrow ) uint8_t[bounds.w * band_height];
+    if ( l_slot->data == nullptr )
+    {
+      l_slot = l_spare;
+      if ( l_slot == nullptr )
+      {
+        return nullptr;
+      }
+    }
+    else
+    {
+      l_slot->surface = new blit::Surface( l_slot->data, blit::PixelFormat::P,
+                                           blit::Size( bounds.w, band_height ) );
+      l_slot->surface->palette = palette;
+    }
+  }
+
+  /* So, unpack the band into it. */
+  if ( !unpack( p_band, l_slot->data ) )
+  {
+    l_slot->band = band_count;
+    l_slot->last_used = 0;
+    return nullptr;
+  }
+  l_slot->band = p_band;
+  l_slot->last_used = ++clock;
+
+  return l_slot->surface;
+}
+
+
+/*
+ * get_bounds - returns the size of the whole image.
+ */
+
+blit::Size PackedImage::get_bounds( void )
+{
+  return bounds;
+}
+
+
+/*
+ * blit - draws part of the image onto a surface, exactly as blit::Surface's
+ *        blit would; a band at a time, unpacking them as we go.
+ *
+ * blit::Surface * - the surface to draw onto
+ * blit::Rect      - the part of the image to draw
+ * blit::Point     - where on the surface to draw it
+ */
+
+void PackedImage::blit( blit::Surface *p_target, blit::Rect p_source, blit::Point p_point )
+{
+  /* Keep to the image itself, moving the destination to match. */
+  blit::Rect l_source = p_source.intersection( blit::Rect( blit::Point( 0, 0 ), bounds ) );
+  if ( l_source.empty() )
+  {
+    return;
+  }
+  p_point.x += l_source.x - p_source.x;
+  p_point.y += l_source.y - p_source.y;
+
+  /* Now work down through the bands that it covers. */
+  int32_t l_line = l_source.y;
+  while( l_line < l_source.y + l_source.h )
+  {
+    uint16_t l_band = l_line / band_height;
+    int32_t  l_top = l_band * band_height;
+    int32_t  l_lines = std::min( l_top + band_height, l_source.y + l_source.h ) - l_line;
+
+    blit::Surface *l_surface = fetch( l_band );
+    if ( l_surface != nullptr )
+    {
+      p_target->blit(
+        l_surface,
+        blit::Rect( l_source.x, l_line - l_top, l_source.w, l_lines ),
+        blit::Point( p_point.x, p_point.y + l_line - l_source.y )
+      );
+    }
+    l_line += l_lines;
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * sprite - draws a sprite onto a surface, exactly as blit::Surface's sprite
+ *          would if this image was its spritesheet.
+ *
+ * blit::Surface * - the surface to draw onto
+ * blit::Rect      - the sprite, in sprite grid units
+ * blit::Point     - where on the surface to draw it
+ */
+
+void PackedImage::sprite( blit::Surface *p_target, blit::Rect p_sprite, blit::Point p_point )
+{
+  blit(
+    p_target,
+    blit::Rect( p_sprite.x * PACKED_SPRITE_SIZE, p_sprite.y * PACKED_SPRITE_SIZE,
+                p_sprite.w * PACKED_SPRITE_SIZE, p_sprite.h * PACKED_SPRITE_SIZE ),
+    p_point
+  );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * flush - throws away every unpacked band, and the memory they were in.
+ */
+
+void PackedImage::flush( void )
+{
+  for ( uint16_t l_index = 0; l_index < cache_size; l_index++ )
+  {
+    delete cache[l_index].surface;
+    delete[] cache[l_index].data;
+    cache[l_index].band = band_count;
+    cache[l_index].last_used = 0;
+    cache[l_index].data = nullptr;
+    cache[l_index].surface = nullptr;
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/* End of PackedImage.cpp */
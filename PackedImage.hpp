@@ -0,0 +1,62 @@
+/*
+ * PackedImage.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * A PackedImage is an image left in the palettized, run length encoded form
+ * that tools/pack_images.py produces; it's unpacked a band of lines at a time,
+ * only when something is drawn from that band, into a small cache of them.
+ */
+
+#ifndef   _PACKEDIMAGE_HPP_
+#define   _PACKEDIMAGE_HPP_
+
+/* How many bands of the spritesheet are kept unpacked at once; the game */
+/* only uses the first few rows of sprites, so this needn't be many.     */
+#ifdef    PICO_BUILD
+#define PACKED_SPRITE_BANDS     6
+#else
+#define PACKED_SPRITE_BANDS     8
+#endif /* PICO_BUILD */
+
+/* The sprite grid, which blit::Surface::sprite works in as well. */
+#define PACKED_SPRITE_SIZE      8
+
+typedef struct
+{
+  uint16_t              band;
+  uint32_t              last_used;
+  uint8_t              *data;
+  blit::Surface        *surface;
+} packed_band_t;
+
+class PackedImage
+{
+private:
+  blit::Size            bounds;
+  uint8_t               band_height;
+  uint16_t              band_count;
+  blit::Pen            *palette;
+  const uint8_t        *offsets;
+  const uint8_t        *stream;
+  packed_band_t        *cache;
+  uint16_t              cache_size;
+  uint32_t              clock;
+
+  bool                  unpack( uint16_t, uint8_t * );
+  blit::Surface        *fetch( uint16_t );
+
+public:
+                        PackedImage( const uint8_t *, uint16_t = 0 );
+                       ~PackedImage( void );
+  blit::Size            get_bounds( void );
+  void                  blit( blit::Surface *, blit::Rect, blit::Point );
+  void                  sprite( blit::Surface *, blit::Rect, blit::Point );
+  void                  flush( void );
+};
+
+#endif /* _PACKEDIMAGE_HPP_ */
+
+/* End of PackedImage.hpp */
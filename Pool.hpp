@@ -0,0 +1,208 @@
+/*
+ * Pool.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * A Pool is a fixed number of slots for objects of one type, set aside up
+ * front; objects are built in a free slot and torn down in place, so once
+ * the pool exists nothing ever touches the heap. Acquiring and releasing are
+ * both constant time, with the free slots and the live objects each kept on
+ * a list threaded through the slot indices.
+ *
+ * Live objects are visited newest first, which is the order the game always
+ * kept its balls and powerups in; that matters, because the order things are
+ * updated in decides the order the random numbers get used in.
+ */
+
+#ifndef   _POOL_HPP_
+#define   _POOL_HPP_
+
+#include <new>
+#include <utility>
+#include <stdint.h>
+
+
+template <typename T, uint16_t N>
+class Pool
+{
+private:
+  static const uint16_t   NONE = 0xffff;
+
+  alignas( T ) uint8_t    slots[N][sizeof( T )];
+  uint16_t                next[N];
+  uint16_t                prev[N];
+  uint16_t                free_head;
+  uint16_t                live_head;
+  uint16_t                live_count;
+
+  T                      *slot( uint16_t p_index ) { return reinterpret_cast<T *>( slots[p_index] ); }
+
+public:
+  /* Iterating a pool hands out pointers to the live objects, so it reads */
+  /* just the same as the lists of pointers it replaces.                  */
+  class iterator
+  {
+  private:
+    Pool                 *pool;
+    uint16_t              index;
+
+  public:
+                          iterator( Pool *p_pool, uint16_t p_index ) : pool( p_pool ), index( p_index ) {}
+    T                    *operator*( void ) const { return pool->slot( index ); }
+    iterator             &operator++( void ) { index = pool->next[index]; return *this; }
+    bool                  operator!=( const iterator &p_other ) const { return index != p_other.index; }
+  };
+
+                          Pool( void ) { reset(); }
+                          ~Pool( void ) { clear(); }
+                          Pool( const Pool & ) = delete;
+  Pool                   &operator=( const Pool & ) = delete;
+
+  iterator                begin( void ) { return iterator( this, live_head ); }
+  iterator                end( void ) { return iterator( this, NONE ); }
+  bool                    empty( void ) const { return live_count == 0; }
+  bool                    full( void ) const { return live_count == N; }
+  uint16_t                size( void ) const { return live_count; }
+  static constexpr uint16_t capacity( void ) { return N; }
+  T                      *front( void ) { return empty() ? nullptr : slot( live_head ); }
+  uint16_t                index_of( const T *p_object ) const
+                          { return (uint16_t)( ( reinterpret_cast<const uint8_t *>( p_object ) - slots[0] ) / sizeof( T ) ); }
+
+
+  /*
+   * acquire - builds a new object in a free slot, passing the arguments on to
+   *           its constructor, and puts it at the front of the live objects.
+   *
+   * Returns the new object, or nullptr if every slot is in use.
+   */
+
+  template <typename... A>
+  T *acquire( A&&... p_args )
+  {
+    /* Nothing we can do if we're out of slots. */
+    if ( free_head == NONE )
+    {
+      return nullptr;
+    }
+
+    /* Take the first free slot, and build the object in it. */
+    uint16_t l_index = free_head;
+    free_head = next[l_index];
+    T *l_object = new( slots[l_index] ) T( std::forward<A>( p_args )... );
+
+    /* And link it in, at the front. */
+    prev[l_index] = NONE;
+    next[l_index] = live_head;
+    if ( live_head != NONE )
+    {
+      prev[live_head] = l_index;
+    }
+    live_head = l_index;
+    live_count++;
+
+    return l_object;
+  }
+
+
+  /*
+   * release - tears down a live object, and hands its slot back.
+   *
+   * T * - the object to release; it must have come from this pool.
+   */
+
+  void release( T *p_object )
+  {
+    uint16_t l_index = index_of( p_object );
+
+    /* Unlink it from the live objects. */
+    if ( prev[l_index] != NONE )
+    {
+      next[prev[l_index]] = next[l_index];
+    }
+    else
+    {
+      live_head = next[l_index];
+    }
+    if ( next[l_index] != NONE )
+    {
+      prev[next[l_index]] = prev[l_index];
+    }
+    live_count--;
+
+    /* Tear it down, and put the slot on the free list. */
+    p_object->~T();
+    next[l_index] = free_head;
+    free_head = l_index;
+
+    /* All done. */
+    return;
+  }
+
+
+  /*
+   * remove_if - releases every live object that the predicate is true for,
+   *             leaving the rest in the same order.
+   */
+
+  template <typename P>
+  void remove_if( P p_predicate )
+  {
+    uint16_t l_index = live_head;
+
+    while( l_index != NONE )
+    {
+      /* Find the next one first, as releasing reuses the link. */
+      uint16_t l_next = next[l_index];
+      if ( p_predicate( slot( l_index ) ) )
+      {
+        release( slot( l_index ) );
+      }
+      l_index = l_next;
+    }
+
+    /* All done. */
+    return;
+  }
+
+
+  /*
+   * clear - releases every live object.
+   */
+
+  void clear( void )
+  {
+    while( live_head != NONE )
+    {
+      release( slot( live_head ) );
+    }
+
+    /* All done. */
+    return;
+  }
+
+
+private:
+  /*
+   * reset - puts every slot on the free list; only for an empty pool.
+   */
+
+  void reset( void )
+  {
+    for ( uint16_t l_index = 0; l_index < N; l_index++ )
+    {
+      next[l_index] = ( l_index + 1 < N ) ? l_index + 1 : NONE;
+    }
+    free_head = ( N > 0 ) ? 0 : NONE;
+    live_head = NONE;
+    live_count = 0;
+
+    /* All done. */
+    return;
+  }
+};
+
+#endif /* _POOL_HPP_ */
+
+/* End of Pool.hpp */
@@ -25,16 +25,23 @@
 
 /*
  * constructor - Spawns a power up at the specified location. 
+ *
+ * powerup_type_t - the type of powerup; the caller rolls the dice for this.
+ * uint16_t       - the height of the playing field, that we fall through.
+ * T              - the speed we fall at, per (sub)step.
  */
 
-PowerUp::PowerUp( blit::Point p_origin )
+template <typename T>
+PowerUpT<T>::PowerUpT( blit::Point p_origin, powerup_type_t p_type, uint16_t p_field_height, T p_speed )
 {
-  /* Save the origin and pick a type. */
-  location = blit::Vec2( p_origin.x, p_origin.y );
-  powerup_type = (powerup_type_t)( blit::random() % POWERUP_MAX );
+  /* Save the origin and type. */
+  location = SimVec<T>( p_origin.x, p_origin.y );
+  last_location = location;
+  powerup_type = p_type;
+  field_height = p_field_height;
 
-  /* And set a default gravity. */
-  vector = blit::Vec2( 0, 0.75f );
+  /* And fall at whatever speed we're asked to. */
+  vector = SimVec<T>( 0, p_speed );
 
   /* All done. */
   return;
@@ -44,13 +51,18 @@ PowerUp::PowerUp( blit::Point p_origin )
 /*
  * get_render_location - returns the render location of the powerup, taking into
  *                       account the dimensions of the thing
+ *
+ * T - how far through the current tick we are, as for a ball.
  */
 
-blit::Point PowerUp::get_render_location( void )
+template <typename T>
+blit::Point PowerUpT<T>::get_render_location( T p_fraction )
 {
+  SimVec<T> l_location = last_location + ( location - last_location ) * p_fraction;
+
   /* The inner location represents the middle of the powerup; powerups will */
   /* always be two sprites wide, so similar to the bat logic.               */
-  return location - blit::Vec2( 8, 4 );
+  return ( l_location - SimVec<T>( 8, 4 ) ).to_point();
 }
 
 
@@ -60,11 +72,12 @@ blit::Point PowerUp::get_render_location( void )
  *              a full two sprites big.
  */
 
-blit::Rect PowerUp::get_bounds( void )
+template <typename T>
+blit::Rect PowerUpT<T>::get_bounds( void )
 {
   return blit::Rect( 
-    location - blit::Vec2( 8, 4 ),
-    location + blit::Vec2( 8, 4 )
+    ( location - SimVec<T>( 8, 4 ) ).to_point(),
+    ( location + SimVec<T>( 8, 4 ) ).to_point()
   );
 }
 
@@ -73,7 +86,8 @@ blit::Rect PowerUp::get_bounds( void )
  * get_type - accessor for the powerup type
  */
 
-powerup_type_t PowerUp::get_type( void )
+template <typename T>
+powerup_type_t PowerUpT<T>::get_type( void )
 {
   return powerup_type;
 }
@@ -83,7 +97,8 @@ powerup_type_t PowerUp::get_type( void )
  * update - updates the location of the powerup.
  */
 
-void PowerUp::update( void )
+template <typename T>
+void PowerUpT<T>::update( void )
 {
   /* This is relatively painless, actually. */
   location += vector;
@@ -94,36 +109,63 @@ void PowerUp::update( void )
 
 
 /*
- * render - draws the powerup on the screem. 
+ * snapshot - remembers where the powerup is at the start of a tick, so that
+ *            it can be drawn part way between ticks.
  */
 
-void PowerUp::render( void )
+template <typename T>
+void PowerUpT<T>::snapshot( void )
 {
-  /* This is a relatively simple sprite blit, with some positionsl alpha. */
-  uint8_t l_oldalpha = blit::screen.alpha;
-  blit::screen.alpha = 255 - ( (int)location.y % 10 ) * 10;
-
-  blit::screen.sprite(
-    blit::Rect( powerup_type * 2, SPRITE_ROW_POWERUP, 2, 1 ),
-    get_render_location()
-  );
-
-  blit::screen.alpha = l_oldalpha;
+  last_location = location;
 
   /* All done. */
   return;
 }
 
 
+/*
+ * get_render_alpha - the powerup flickers as it falls; this works out the
+ *                    alpha to draw it with, based on where it is.
+ */
+
+template <typename T>
+uint8_t PowerUpT<T>::get_render_alpha( void )
+{
+  return 255 - ( sim_to_int( location.y ) % 10 ) * 10;
+}
+
+
 /*
  * remove - drops the powerup off the bottom of the screen; this flags it
  *          for removal from the internal lists later.
  */
 
-void PowerUp::remove( void )
+template <typename T>
+void PowerUpT<T>::remove( void )
+{
+  location.y = T( field_height + 10 );
+}
+
+
+/*
+ * hash - folds the state of the powerup into a running hash.
+ *
+ * uint32_t - the hash so far
+ */
+
+template <typename T>
+uint32_t PowerUpT<T>::hash( uint32_t p_hash )
 {
-  location.y = blit::screen.bounds.h + 10;
+  p_hash = hash_fnv1a( p_hash, &location, sizeof( location ) );
+  p_hash = hash_fnv1a( p_hash, &powerup_type, sizeof( powerup_type ) );
+  return p_hash;
 }
 
 
+/* Built for both number types, the same as the ball. */
+
+template class PowerUpT<float>;
+template class PowerUpT<Fixed>;
+
+
 /* End of PowerUp.cpp */
@@ -11,6 +11,8 @@
 #ifndef   _POWERUP_HPP_
 #define   _POWERUP_HPP_
 
+#include "SimMath.hpp"
+
 typedef enum
 {
   POWERUP_SPEED,
@@ -23,23 +25,31 @@ typedef enum
   POWERUP_MAX
 } powerup_type_t;
 
-class PowerUp
+/* Like the ball, powerups are written against a number type. */
+template <typename T>
+class PowerUpT
 {
 private:
-  blit::Vec2      location;
-  blit::Vec2      vector;
+  SimVec<T>       location;
+  SimVec<T>       last_location;
+  SimVec<T>       vector;
   powerup_type_t  powerup_type;
-  blit::Point     get_render_location( void );
+  uint16_t        field_height;
 
 public:
-                  PowerUp( blit::Point );
+                  PowerUpT( blit::Point, powerup_type_t, uint16_t, T = T( 0.75f ) );
   blit::Rect      get_bounds( void );
+  blit::Point     get_render_location( T = T( 1 ) );
+  uint8_t         get_render_alpha( void );
   powerup_type_t  get_type( void );
   void            update( void );
-  void            render( void );
+  void            snapshot( void );
   void            remove( void );
+  uint32_t        hash( uint32_t );
 };
 
+typedef PowerUpT<sim_num_t> PowerUp;
+
 #endif /* _POWERUP_HPP_ */
 
 /* End of PowerUp.hpp */
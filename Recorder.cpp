@@ -0,0 +1,156 @@
+/*
+ * Recorder.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The Recorder writes replays out through the blit file API; ticks are
+ * gathered up into a buffer, so that we're not hitting the SD card every 10ms.
+ */
+
+/* System headers. */
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "Recorder.hpp"
+
+
+/* Functions. */
+
+/*
+ * constructor - nothing is recorded until we're started.
+ */
+
+Recorder::Recorder( void )
+{
+  file_offset = 0;
+  buffer_used = 0;
+  active = false;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * start - opens a fresh replay file, and writes the header to it. Any replay
+ *         already being recorded is closed off first.
+ *
+ * replay_header_t * - the header describing the game being recorded
+ */
+
+void Recorder::start( const replay_header_t *p_header )
+{
+  /* Finish off anything we were already doing. */
+  stop();
+
+  /* Make sure we have somewhere to write to. */
+  if ( !blit::directory_exists( GAME_DATAFILE_DIR ) )
+  {
+    blit::create_directory( ".gamedata" );
+    blit::create_directory( GAME_DATAFILE_DIR );
+  }
+
+  /* And open the file; if we can't, we just don't record. */
+  if ( !file.open( GAME_DATAFILE_REPLAY, blit::OpenMode::write ) )
+  {
+    return;
+  }
+
+  /* The header goes first. */
+  replay_write_header( p_header, buffer );
+  buffer_used = REPLAY_HEADER_SIZE;
+  file_offset = 0;
+  active = true;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * record - adds a tick to the replay.
+ *
+ * sim_input_t * - the input given to the simulation
+ * uint32_t      - the simulation hash after the tick
+ */
+
+void Recorder::record( const sim_input_t *p_input, uint32_t p_hash )
+{
+  /* Nothing to do if we're not recording. */
+  if ( !active )
+  {
+    return;
+  }
+
+  /* Make sure there's room in the buffer. */
+  if ( buffer_used + REPLAY_TICK_SIZE > RECORDER_BUFFER_SIZE )
+  {
+    flush();
+  }
+
+  /* And add the tick. */
+  replay_write_tick( p_input, p_hash, &buffer[buffer_used] );
+  buffer_used += REPLAY_TICK_SIZE;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * flush - writes out whatever is in the buffer.
+ */
+
+void Recorder::flush( void )
+{
+  /* Write out the buffer, and move along the file. */
+  if ( buffer_used > 0 )
+  {
+    file.write( file_offset, buffer_used, (const char *)buffer );
+    file_offset += buffer_used;
+    buffer_used = 0;
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * stop - flushes out anything left in the buffer, and closes the replay.
+ */
+
+void Recorder::stop( void )
+{
+  /* Nothing to do if we're not recording. */
+  if ( !active )
+  {
+    return;
+  }
+
+  /* Flush and close. */
+  flush();
+  file.close();
+  active = false;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * is_active - returns true if we're currently recording.
+ */
+
+bool Recorder::is_active( void )
+{
+  return active;
+}
+
+
+/* End of Recorder.cpp */
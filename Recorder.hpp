@@ -0,0 +1,41 @@
+/*
+ * Recorder.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The Recorder captures the game being played into a replay file, so that
+ * any odd behaviour can be reproduced exactly, later on.
+ */
+
+#ifndef   _RECORDER_HPP_
+#define   _RECORDER_HPP_
+
+#include "GameSim.hpp"
+#include "Replay.hpp"
+
+#define RECORDER_BUFFER_SIZE  512
+
+class Recorder
+{
+private:
+  blit::File      file;
+  uint32_t        file_offset;
+  uint8_t         buffer[RECORDER_BUFFER_SIZE];
+  uint16_t        buffer_used;
+  bool            active;
+
+  void            flush( void );
+
+public:
+                  Recorder( void );
+  void            start( const replay_header_t * );
+  void            record( const sim_input_t *, uint32_t );
+  void            stop( void );
+  bool            is_active( void );
+};
+
+#endif /* _RECORDER_HPP_ */
+
+/* End of Recorder.hpp */
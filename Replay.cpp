@@ -0,0 +1,170 @@
+/*
+ * Replay.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * These functions pack and unpack the replay format; they deal purely with
+ * buffers, leaving the actual file handling to whoever is recording or
+ * replaying, because that's rather different on a 32blit and a desktop.
+ *
+ * Everything is stored little-endian. The header is:
+ *
+ *   0  char[4]  magic ("32BR")
+ *   4  uint8_t  format version
+ *   5  uint8_t  target type
+ *   6  uint16_t field width
+ *   8  uint16_t field height
+ *  10  uint8_t  flags (REPLAY_FLAG_*)
+ *  11  uint8_t  physics substeps per tick (zero, in older recordings, is one)
+ *  12  uint32_t random seed
+ *
+ * And it's followed by one four byte record per tick:
+ *
+ *   0  uint8_t  buttons (SIM_INPUT_*)
+ *   1  int8_t   joystick
+ *   2  uint16_t state hash after the tick, folded to 16 bits
+ */
+
+/* System headers. */
+
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "Replay.hpp"
+
+
+/* Functions. */
+
+/*
+ * replay_write_header - packs the header into a buffer.
+ *
+ * replay_header_t * - the header to pack
+ * uint8_t *         - the buffer, at least REPLAY_HEADER_SIZE bytes long
+ */
+
+void replay_write_header( const replay_header_t *p_header, uint8_t *p_buffer )
+{
+  memcpy( p_buffer, REPLAY_MAGIC, 4 );
+  p_buffer[4] = p_header->version;
+  p_buffer[5] = (uint8_t)p_header->target;
+  p_buffer[6] = p_header->width & 0xff;
+  p_buffer[7] = p_header->width >> 8;
+  p_buffer[8] = p_header->height & 0xff;
+  p_buffer[9] = p_header->height >> 8;
+  p_buffer[10] = p_header->flags;
+  p_buffer[11] = p_header->substeps;
+  for ( uint8_t l_byte = 0; l_byte < 4; l_byte++ )
+  {
+    p_buffer[12 + l_byte] = ( p_header->seed >> ( l_byte * 8 ) ) & 0xff;
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * replay_read_header - unpacks the header from a buffer.
+ *
+ * replay_header_t * - where to unpack the header to
+ * uint8_t *         - the buffer, at least REPLAY_HEADER_SIZE bytes long
+ *
+ * Returns a bool flag, false if this isn't a replay we understand, or one
+ * that couldn't have been recorded.
+ */
+
+bool replay_read_header( replay_header_t *p_header, const uint8_t *p_buffer )
+{
+  /* Check that this is a replay, and a version we know. */
+  if ( memcmp( p_buffer, REPLAY_MAGIC, 4 ) != 0 || p_buffer[4] != REPLAY_VERSION )
+  {
+    return false;
+  }
+
+  /* The target picks the levels, and the field can't be empty; anything */
+  /* else means the file is damaged, and can't be played back safely.    */
+  if ( p_buffer[5] >= TARGET_MAX || ( p_buffer[6] | p_buffer[7] ) == 0 || ( p_buffer[8] | p_buffer[9] ) == 0 )
+  {
+    return false;
+  }
+
+  /* Then just unpack it. */
+  p_header->version = p_buffer[4];
+  p_header->target = (target_type_t)p_buffer[5];
+  p_header->width = p_buffer[6] | ( p_buffer[7] << 8 );
+  p_header->height = p_buffer[8] | ( p_buffer[9] << 8 );
+  p_header->flags = p_buffer[10];
+  p_header->substeps = ( p_buffer[11] == 0 ) ? 1 : p_buffer[11];
+  p_header->seed = 0;
+  for ( uint8_t l_byte = 0; l_byte < 4; l_byte++ )
+  {
+    p_header->seed |= (uint32_t)p_buffer[12 + l_byte] << ( l_byte * 8 );
+  }
+
+  /* All done. */
+  return true;
+}
+
+
+/*
+ * replay_write_tick - packs a single tick into a buffer.
+ *
+ * sim_input_t * - the input given to the simulation for this tick
+ * uint32_t      - the simulation hash after the tick
+ * uint8_t *     - the buffer, at least REPLAY_TICK_SIZE bytes long
+ */
+
+void replay_write_tick( const sim_input_t *p_input, uint32_t p_hash, uint8_t *p_buffer )
+{
+  uint16_t l_hash = replay_fold_hash( p_hash );
+
+  p_buffer[0] = p_input->buttons;
+  p_buffer[1] = (uint8_t)p_input->joystick;
+  p_buffer[2] = l_hash & 0xff;
+  p_buffer[3] = l_hash >> 8;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * replay_read_tick - unpacks a single tick from a buffer.
+ *
+ * sim_input_t * - where to unpack the input to
+ * uint16_t *    - where to unpack the (folded) hash to
+ * uint8_t *     - the buffer, at least REPLAY_TICK_SIZE bytes long
+ */
+
+void replay_read_tick( sim_input_t *p_input, uint16_t *p_hash, const uint8_t *p_buffer )
+{
+  p_input->buttons = p_buffer[0];
+  p_input->joystick = (int8_t)p_buffer[1];
+  *p_hash = p_buffer[2] | ( p_buffer[3] << 8 );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * replay_fold_hash - folds a full state hash down to the 16 bits we store; a
+ *                    divergence that slips through one tick won't last long.
+ *
+ * uint32_t - the full state hash
+ */
+
+uint16_t replay_fold_hash( uint32_t p_hash )
+{
+  return ( p_hash >> 16 ) ^ ( p_hash & 0xffff );
+}
+
+
+/* End of Replay.cpp */
@@ -0,0 +1,56 @@
+/*
+ * Replay.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * Replays are a recording of everything needed to play a game again, exactly;
+ * the random seed, and the input for every tick. Each tick also carries a
+ * (folded) hash of the simulation state, so divergence can be pinned down.
+ */
+
+#ifndef   _REPLAY_HPP_
+#define   _REPLAY_HPP_
+
+#include "GameSim.hpp"
+
+#define REPLAY_MAGIC        "32BR"
+#define REPLAY_VERSION      1
+#define REPLAY_HEADER_SIZE  16
+#define REPLAY_TICK_SIZE    4
+
+/* Flags describe how the recording build did its sums; a replay can only */
+/* be checked by a build that does them the same way. The rest of the     */
+/* flags are the rules the game was played under.                         */
+#define REPLAY_FLAG_FIXED   0x01
+#define REPLAY_FLAG_MEGA    0x02
+#define REPLAY_FLAG_PACK    0x04
+#define REPLAY_BUILD_MASK   REPLAY_FLAG_FIXED
+
+#ifdef    BLOX_FIXED_POINT
+#define REPLAY_BUILD_FLAGS  REPLAY_FLAG_FIXED
+#else
+#define REPLAY_BUILD_FLAGS  0
+#endif /* BLOX_FIXED_POINT */
+
+typedef struct
+{
+  uint8_t         version;
+  target_type_t   target;
+  uint8_t         flags;
+  uint8_t         substeps;
+  uint16_t        width;
+  uint16_t        height;
+  uint32_t        seed;
+} replay_header_t;
+
+void      replay_write_header( const replay_header_t *, uint8_t * );
+bool      replay_read_header( replay_header_t *, const uint8_t * );
+void      replay_write_tick( const sim_input_t *, uint32_t, uint8_t * );
+void      replay_read_tick( sim_input_t *, uint16_t *, const uint8_t * );
+uint16_t  replay_fold_hash( uint32_t );
+
+#endif /* _REPLAY_HPP_ */
+
+/* End of Replay.hpp */
@@ -0,0 +1,139 @@
+/*
+ * SimMath.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * SimMath holds the numeric types the game physics is built on. The physics
+ * is written against a number type, so that it can run in plain floats where
+ * there is an FPU, or in Q16.16 fixed point where there isn't (PicoSystem).
+ * Fixed point is pure integer maths, so it gives bit-identical results on
+ * every platform.
+ *
+ * Directions are kept as a step around a full turn, rather than an angle;
+ * turning and reflecting become integer sums, and the unit vector for any
+ * direction is a table lookup, so there's no trig left on the hot path.
+ */
+
+#ifndef   _SIMMATH_HPP_
+#define   _SIMMATH_HPP_
+
+#include <math.h>
+#include <stdint.h>
+
+
+/* Fixed is a signed Q16.16 fixed point number; 16 bits of integer, and 16 */
+/* bits of fraction. Multiplies and divides go via 64 bits, and divides     */
+/* saturate rather than wrapping if the result won't fit.                  */
+class Fixed
+{
+public:
+  int32_t                 raw;
+
+  constexpr               Fixed( void ) : raw( 0 ) {}
+  constexpr               Fixed( int p_value ) : raw( p_value * 65536 ) {}
+  constexpr               Fixed( float p_value )
+                            : raw( (int32_t)( p_value * 65536.0f + ( p_value < 0.0f ? -0.5f : 0.5f ) ) ) {}
+  constexpr               Fixed( double p_value )
+                            : raw( (int32_t)( p_value * 65536.0 + ( p_value < 0.0 ? -0.5 : 0.5 ) ) ) {}
+
+  static constexpr Fixed  from_raw( int32_t p_raw ) { Fixed l_fixed; l_fixed.raw = p_raw; return l_fixed; }
+  constexpr int32_t       to_int( void ) const { return raw / 65536; }
+  constexpr int32_t       floor( void ) const { return raw >> 16; }
+  constexpr float         to_float( void ) const { return raw / 65536.0f; }
+
+  constexpr Fixed         operator-( void ) const { return from_raw( -raw ); }
+  Fixed                  &operator+=( Fixed p_other ) { raw += p_other.raw; return *this; }
+  Fixed                  &operator-=( Fixed p_other ) { raw -= p_other.raw; return *this; }
+  Fixed                  &operator*=( Fixed p_other ) { *this = *this * p_other; return *this; }
+  Fixed                  &operator/=( Fixed p_other ) { *this = *this / p_other; return *this; }
+
+  friend constexpr Fixed  operator+( Fixed a, Fixed b ) { return from_raw( a.raw + b.raw ); }
+  friend constexpr Fixed  operator-( Fixed a, Fixed b ) { return from_raw( a.raw - b.raw ); }
+  friend constexpr Fixed  operator*( Fixed a, Fixed b ) { return from_raw( (int32_t)( ( (int64_t)a.raw * b.raw ) >> 16 ) ); }
+  friend Fixed            operator/( Fixed a, Fixed b );
+
+  friend constexpr bool   operator==( Fixed a, Fixed b ) { return a.raw == b.raw; }
+  friend constexpr bool   operator!=( Fixed a, Fixed b ) { return a.raw != b.raw; }
+  friend constexpr bool   operator<( Fixed a, Fixed b ) { return a.raw < b.raw; }
+  friend constexpr bool   operator>( Fixed a, Fixed b ) { return a.raw > b.raw; }
+  friend constexpr bool   operator<=( Fixed a, Fixed b ) { return a.raw <= b.raw; }
+  friend constexpr bool   operator>=( Fixed a, Fixed b ) { return a.raw >= b.raw; }
+};
+
+
+/* The handful of maths functions the physics needs, for both number types. */
+inline int32_t  sim_to_int( float p_value ) { return (int32_t)p_value; }
+inline int32_t  sim_floor( float p_value ) { return (int32_t)floorf( p_value ); }
+inline float    sim_abs( float p_value ) { return fabsf( p_value ); }
+inline float    sim_to_float( float p_value ) { return p_value; }
+
+inline int32_t  sim_to_int( Fixed p_value ) { return p_value.to_int(); }
+inline int32_t  sim_floor( Fixed p_value ) { return p_value.floor(); }
+inline Fixed    sim_abs( Fixed p_value ) { return p_value.raw < 0 ? -p_value : p_value; }
+inline float    sim_to_float( Fixed p_value ) { return p_value.to_float(); }
+
+/* Tables are held as Q16.16, which either number type can be built from. */
+template <typename T> T sim_from_raw( int32_t );
+template <> inline float sim_from_raw<float>( int32_t p_raw ) { return p_raw / 65536.0f; }
+template <> inline Fixed sim_from_raw<Fixed>( int32_t p_raw ) { return Fixed::from_raw( p_raw ); }
+
+
+/* Directions are steps around a full turn, clockwise from pointing right */
+/* (because y points down the screen); 1024 steps is about a third of a   */
+/* degree each, which is plenty.                                          */
+#define SIM_DIRECTIONS          1024
+#define SIM_DIRECTION_MASK      ( SIM_DIRECTIONS - 1 )
+#define SIM_DIRECTION_UP        768
+#define SIM_STEPS_PER_RADIAN    163
+
+void            sim_direction_raw( uint16_t, int32_t *, int32_t * );
+
+
+/* SimVec is a two dimensional vector of either number type; it does just */
+/* what blit::Vec2 does, but without insisting on floats.                 */
+template <typename T>
+class SimVec
+{
+public:
+  T                       x;
+  T                       y;
+
+                          SimVec( void ) : x( 0 ), y( 0 ) {}
+                          SimVec( T p_x, T p_y ) : x( p_x ), y( p_y ) {}
+
+  SimVec                 &operator+=( const SimVec &p_other ) { x += p_other.x; y += p_other.y; return *this; }
+  SimVec                 &operator-=( const SimVec &p_other ) { x -= p_other.x; y -= p_other.y; return *this; }
+  SimVec                  operator+( const SimVec &p_other ) const { return SimVec( x + p_other.x, y + p_other.y ); }
+  SimVec                  operator-( const SimVec &p_other ) const { return SimVec( x - p_other.x, y - p_other.y ); }
+  SimVec                  operator*( T p_scale ) const { return SimVec( x * p_scale, y * p_scale ); }
+
+  T                       dot( const SimVec &p_other ) const { return x * p_other.x + y * p_other.y; }
+  T                       cross( const SimVec &p_other ) const { return x * p_other.y - y * p_other.x; }
+  blit::Point             to_point( void ) const { return blit::Point( sim_to_int( x ), sim_to_int( y ) ); }
+};
+
+
+/* sim_direction fetches the unit vector for a direction, from the tables. */
+template <typename T>
+SimVec<T> sim_direction( uint16_t p_direction )
+{
+  int32_t l_x, l_y;
+  sim_direction_raw( p_direction, &l_x, &l_y );
+  return SimVec<T>( sim_from_raw<T>( l_x ), sim_from_raw<T>( l_y ) );
+}
+
+
+/* And the number type the game actually uses is chosen at build time. */
+#ifdef    BLOX_FIXED_POINT
+typedef Fixed           sim_num_t;
+#else
+typedef float           sim_num_t;
+#endif /* BLOX_FIXED_POINT */
+
+typedef SimVec<sim_num_t> sim_vec_t;
+
+#endif /* _SIMMATH_HPP_ */
+
+/* End of SimMath.hpp */
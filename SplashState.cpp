@@ -15,7 +15,6 @@
 
 #include "32blit.hpp"
 #include "32blox.hpp"
-#include "assets_images.hpp"
 
 #include "SplashState.hpp"
 
@@ -28,12 +27,8 @@
 
 SplashState::SplashState( void )
 {
-  /* And compute the gradient colours for the background. */
-  for ( uint16_t i = 0; i < SPLASHSTATE_GRADIENT_HEIGHT / 2; i++ )
-  {
-    gradient_pen[i] = gradient_pen[SPLASHSTATE_GRADIENT_HEIGHT - i - 1]
-                    = blit::Pen( 40 - i / 2, 10 + i, 30 + i / 2 );
-  }
+  /* The background gradient starts from the top. */
+  gradient_offset = 0;
 
   /* The font pen will be simpler. */
   font_pen = blit::Pen( 255, 255, 0 );
@@ -58,8 +53,9 @@ void SplashState::init( GameStateInterface *p_previous )
   logo_tween_x.start();
   logo_tween_y.start();
 
-  /* Select the game spritesheet into the screen. */
-  blit::screen.sprites = assets.spritesheet_game;
+  /* Fetch the logo, and the game spritesheet. */
+  logo = assets.acquire( ASSET_LOGO );
+  spritesheet = assets.acquire( ASSET_GAME_SPRITES );
 
   /* All done. */
   return;
@@ -79,6 +75,11 @@ void SplashState::fini( GameStateInterface *p_next )
   logo_tween_x.stop();
   logo_tween_y.stop();
 
+  /* And let go of the backdrop and images, until they're needed again. */
+  backdrop.release();
+  assets.release( ASSET_LOGO );
+  assets.release( ASSET_GAME_SPRITES );
+
   /* And return. */
   return; 
 }
@@ -100,7 +101,7 @@ gamestate_t SplashState::update( uint32_t p_time )
 
   /* In this state, we'll update the background gradient, to make it look */
   /* pretty (or at least, moving so it's obvious we haven't crashed)      */
-  if ( SPLASHSTATE_GRADIENT_HEIGHT < ++gradient_offset )
+  if ( backdrop.get_period( BACKDROP_TITLE ) <= ++gradient_offset )
   {
     gradient_offset = 0;
   }
@@ -121,61 +122,62 @@ gamestate_t SplashState::update( uint32_t p_time )
 
 void SplashState::render( uint32_t p_time )
 {
-  /* Clear the screen down. */
-  blit::screen.clear();
-
   /* Draw an animated background gradient, to look pretty. */
-  for ( uint16_t i = 0; i < blit::screen.bounds.h; i++ )
-  {
-    blit::screen.pen = gradient_pen[( i + gradient_offset ) % SPLASHSTATE_GRADIENT_HEIGHT];
-    blit::screen.h_span( blit::Point( 0, i ), blit::screen.bounds.w );
-  }
+  backdrop.render( BACKDROP_TITLE, gradient_offset );
 
   /* Place the logo in the middle of the screen. */
   blit::Point l_pos;
-  l_pos.x = (blit::screen.bounds.w - assets.surface_logo->bounds.w) / 2;
-  l_pos.y = ((blit::screen.bounds.h - assets.surface_logo->bounds.h) / 2) - 20;
+  l_pos.x = (blit::screen.bounds.w - logo->get_bounds().w) / 2;
+  l_pos.y = ((blit::screen.bounds.h - logo->get_bounds().h) / 2) - 20;
   l_pos.x += logo_tween_x.value;
   l_pos.y += logo_tween_y.value;
-  blit::screen.blit( assets.surface_logo, assets.surface_logo->clip, l_pos );
+  logo->blit( &blit::screen, blit::Rect( blit::Point( 0, 0 ), logo->get_bounds() ), l_pos );
 
   /* And some bricks in the corners, from the spritesheet. */
-  blit::screen.sprite( 
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 0, SPRITE_ROW_BRICK, 4, 2 ),
     blit::Point( 0, 0 )
   );
-  blit::screen.sprite( 
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 4, SPRITE_ROW_BRICK, 4, 2 ),
     blit::Point( 32, 0 )
   );
-  blit::screen.sprite( 
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 4, SPRITE_ROW_BRICK, 4, 2 ),
     blit::Point( blit::screen.bounds.w - 64, 0 )
   );
-  blit::screen.sprite( 
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 0, SPRITE_ROW_BRICK, 4, 2 ),
     blit::Point( blit::screen.bounds.w - 32, 0 )
   );
-  blit::screen.sprite( 
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 0, SPRITE_ROW_BRICK, 4, 2 ),
     blit::Point( 0, blit::screen.bounds.h - 16 )
   );
-  blit::screen.sprite( 
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 4, SPRITE_ROW_BRICK, 4, 2 ),
     blit::Point( 32, blit::screen.bounds.h - 16 )
   );
-  blit::screen.sprite( 
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 4, SPRITE_ROW_BRICK, 4, 2 ),
     blit::Point( blit::screen.bounds.w - 64, blit::screen.bounds.h - 16 )
   );
-  blit::screen.sprite( 
+  spritesheet->sprite(
+    &blit::screen,
     blit::Rect( 0, SPRITE_ROW_BRICK, 4, 2 ),
     blit::Point( blit::screen.bounds.w - 32, blit::screen.bounds.h - 16 )
   );
 
   /* Lastly, prompt the user to press a button. */
   blit::screen.pen = font_pen;
-  blit::screen.text(
+  text_cache.text(
     assets.get_text( STR_A_TO_START),
     assets.message_font,
     blit::Point( blit::screen.bounds.w / 2, blit::screen.bounds.h - 45 ),
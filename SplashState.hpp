@@ -13,19 +13,22 @@
 #define   _SPLASHSTATE_HPP_
 
 #include "AssetFactory.hpp"
-
-#define SPLASHSTATE_GRADIENT_HEIGHT 160
+#include "Backdrop.hpp"
+#include "TextCache.hpp"
 
 class SplashState : public GameStateInterface
 {
 private:
   AssetFactory   &assets = AssetFactory::get_instance();
+  Backdrop       &backdrop = Backdrop::get_instance();
+  TextCache      &text_cache = TextCache::get_instance();
   blit::Pen       font_pen;
   blit::Tween     font_tween;
   blit::Tween     logo_tween_x;
   blit::Tween     logo_tween_y;
-  blit::Pen       gradient_pen[SPLASHSTATE_GRADIENT_HEIGHT];
   uint8_t         gradient_offset;
+  PackedImage    *logo;
+  PackedImage    *spritesheet;
 
 public:
                   SplashState( void );
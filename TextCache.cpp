@@ -0,0 +1,311 @@
+/*
+ * TextCache.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The TextCache is a singleton class which keeps rendered runs of text in an
+ * atlas surface. It's a drop-in for blit::screen.text, drawing in whatever
+ * the screen pen is; anything it can't (or won't) cache is passed straight
+ * through to the real thing.
+ */
+
+/* System headers. */
+
+#include <new>
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "TextCache.hpp"
+
+
+/* Functions. */
+
+/*
+ * constructor - the atlas isn't allocated until there's text to put in it.
+ */
+
+TextCache::TextCache( void )
+{
+  atlas_data = nullptr;
+  atlas = nullptr;
+  atlas_failed = false;
+  for ( uint8_t l_index = 0; l_index < TEXTCACHE_SLOTS; l_index++ )
+  {
+    entries[l_index].valid = false;
+    entries[l_index].last_used = 0;
+  }
+  memset( seen, 0, sizeof( seen ) );
+  seen_next = 0;
+  clock = 0;
+  reset_stats();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * get_instance - fetches the singleton instance of the TextCache
+ */
+
+TextCache &TextCache::get_instance( void )
+{
+  static TextCache myself;
+  return myself;
+}
+
+
+/*
+ * prepare - makes sure the atlas exists; if there isn't the memory for it,
+ *           we only try the once, and pass everything through after that.
+ *
+ * Returns true if the atlas is ready for use.
+ */
+
+bool TextCache::prepare( void )
+{
+  if ( atlas != nullptr )
+  {
+    return true;
+  }
+  if ( atlas_failed )
+  {
+    return false;
+  }
+
+  /* The atlas is RGBA, so that the text can be blended onto anything. */
+  blit::Size l_size( TEXTCACHE_SLOT_WIDTH, TEXTCACHE_SLOT_HEIGHT * TEXTCACHE_SLOTS );
+  atlas_data = new( std::nothrow ) uint8_t[l_size.w * l_size.h * 4];
+  if ( atlas_data == nullptr )
+  {
+    atlas_failed = true;
+    return false;
+  }
+  atlas = new blit::Surface( atlas_data, blit::PixelFormat::RGBA, l_size );
+
+  return true;
+}
+
+
+/*
+ * admit - decides if some text is worth caching; only if it's been asked for
+ *         recently, otherwise we just remember that it has been, now.
+ *
+ * uint32_t - the hash of the text
+ *
+ * Returns true if the text should be cached.
+ */
+
+bool TextCache::admit( uint32_t p_hash )
+{
+  for ( uint8_t l_index = 0; l_index < TEXTCACHE_SEEN; l_index++ )
+  {
+    if ( seen[l_index] == p_hash )
+    {
+      return true;
+    }
+  }
+
+  seen[seen_next] = p_hash;
+  seen_next = ( seen_next + 1 ) % TEXTCACHE_SEEN;
+  return false;
+}
+
+
+/*
+ * find - looks for some text in the atlas.
+ *
+ * uint32_t           - the hash of the text, font and pen
+ * const char *       - the text
+ * const blit::Font & - the font
+ * bool               - true if the font is variable width
+ *
+ * Returns the entry if it's there, or nullptr if not.
+ */
+
+textcache_entry_t *TextCache::find( uint32_t p_hash, const char *p_text,
+                                    const blit::Font &p_font, bool p_variable )
+{
+  const blit::Pen &l_pen = blit::screen.pen;
+
+  for ( uint8_t l_index = 0; l_index < TEXTCACHE_SLOTS; l_index++ )
+  {
+    textcache_entry_t *l_entry = &entries[l_index];
+
+    /* The hash rules out nearly everything; the rest has to be checked. */
+    if ( l_entry->valid && l_entry->hash == p_hash && l_entry->font == &p_font &&
+         l_entry->variable == p_variable &&
+         l_entry->pen.r == l_pen.r && l_entry->pen.g == l_pen.g &&
+         l_entry->pen.b == l_pen.b && l_entry->pen.a == l_pen.a &&
+         strcmp( l_entry->text, p_text ) == 0 )
+    {
+      return l_entry;
+    }
+  }
+
+  return nullptr;
+}
+
+
+/*
+ * fill - renders some text into the atlas, in the least recently used slot.
+ *
+ * uint32_t           - the hash of the text, font and pen
+ * const char *       - the text
+ * const blit::Font & - the font
+ * bool               - true if the font is variable width
+ * blit::Size         - the size of the rendered text
+ *
+ * Returns the entry it was put in.
+ */
+
+textcache_entry_t *TextCache::fill( uint32_t p_hash, const char *p_text, const blit::Font &p_font,
+                                    bool p_variable, blit::Size p_size )
+{
+  uint8_t l_slot = 0;
+
+  /* Find an empty slot, or failing that the one used longest ago. */
+  for ( uint8_t l_index = 0; l_index < TEXTCACHE_SLOTS; l_index++ )
+  {
+    if ( !entries[l_index].valid )
+    {
+      l_slot = l_index;
+      break;
+    }
+    if ( entries[l_index].last_used < entries[l_slot].last_used )
+    {
+      l_slot = l_index;
+    }
+  }
+
+  /* Clear it right down to transparent, and draw the text into it. */
+  blit::Rect l_rect( 0, l_slot * TEXTCACHE_SLOT_HEIGHT, TEXTCACHE_SLOT_WIDTH, TEXTCACHE_SLOT_HEIGHT );
+  memset( atlas_data + l_rect.y * l_rect.w * 4, 0, l_rect.w * l_rect.h * 4 );
+  atlas->pen = blit::screen.pen;
+  atlas->alpha = 255;
+  atlas->clip = l_rect;
+  atlas->text( p_text, p_font, l_rect.tl(), p_variable, blit::TextAlign::top_left );
+  atlas->clip = blit::Rect( blit::Point( 0, 0 ), atlas->bounds );
+
+  /* And remember what's there. */
+  textcache_entry_t *l_entry = &entries[l_slot];
+  l_entry->hash = p_hash;
+  strcpy( l_entry->text, p_text );
+  l_entry->font = &p_font;
+  l_entry->pen = blit::screen.pen;
+  l_entry->variable = p_variable;
+  l_entry->size = p_size;
+  l_entry->valid = true;
+
+  return l_entry;
+}
+
+
+/*
+ * text - draws text onto the screen, in the current screen pen, exactly as
+ *        blit::screen.text would; from the atlas if we can.
+ *
+ * const char *       - the text
+ * const blit::Font & - the font
+ * const blit::Point & - where to draw it, according to the alignment
+ * bool               - true if the font is variable width
+ * blit::TextAlign    - how the text is aligned to the point
+ */
+
+void TextCache::text( const char *p_text, const blit::Font &p_font, const blit::Point &p_point,
+                      bool p_variable, blit::TextAlign p_align )
+{
+  /* Long text, or text over several lines, isn't worth the trouble. */
+  if ( strlen( p_text ) >= TEXTCACHE_MAX_LENGTH || strchr( p_text, '\n' ) != nullptr || !prepare() )
+  {
+    stats.bypasses++;
+    blit::screen.text( p_text, p_font, p_point, p_variable, p_align );
+    return;
+  }
+
+  /* Work out the key, from everything that decides what the text looks like. */
+  const blit::Font *l_font = &p_font;
+  uint32_t l_hash = hash_fnv1a( HASH_SEED, p_text, strlen( p_text ) );
+  l_hash = hash_fnv1a( l_hash, &l_font, sizeof( l_font ) );
+  l_hash = hash_fnv1a( l_hash, &blit::screen.pen, sizeof( blit::screen.pen ) );
+  l_hash = hash_fnv1a( l_hash, &p_variable, sizeof( p_variable ) );
+
+  /* See if we've got it already, and if not, if it's worth keeping. */
+  textcache_entry_t *l_entry = find( l_hash, p_text, p_font, p_variable );
+  if ( l_entry != nullptr )
+  {
+    stats.hits++;
+  }
+  else
+  {
+    blit::Size l_size = blit::screen.measure_text( p_text, p_font, p_variable );
+    if ( l_size.w > TEXTCACHE_SLOT_WIDTH || l_size.h > TEXTCACHE_SLOT_HEIGHT || !admit( l_hash ) )
+    {
+      stats.bypasses++;
+      blit::screen.text( p_text, p_font, p_point, p_variable, p_align );
+      return;
+    }
+    stats.misses++;
+    l_entry = fill( l_hash, p_text, p_font, p_variable, l_size );
+  }
+  l_entry->last_used = ++clock;
+
+  /* Line it up the same way the text itself would have been. */
+  blit::Point l_point = p_point;
+  if ( p_align & blit::TextAlign::center_h )
+  {
+    l_point.x += ( 0 - l_entry->size.w ) / 2;
+  }
+  if ( p_align & blit::TextAlign::right )
+  {
+    l_point.x -= l_entry->size.w;
+  }
+  if ( p_align & blit::TextAlign::center_v )
+  {
+    l_point.y += ( 0 - l_entry->size.h ) / 2;
+  }
+  if ( p_align & blit::TextAlign::bottom )
+  {
+    l_point.y -= l_entry->size.h;
+  }
+
+  /* And copy it out of the atlas. */
+  blit::screen.blit(
+    atlas,
+    blit::Rect( 0, ( l_entry - entries ) * TEXTCACHE_SLOT_HEIGHT, l_entry->size.w, l_entry->size.h ),
+    l_point
+  );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * get_stats / reset_stats - keep count of how well the cache is doing; the
+ *                           hit rate is hits over all three counts together.
+ */
+
+const textcache_stats_t *TextCache::get_stats( void )
+{
+  return &stats;
+}
+void TextCache::reset_stats( void )
+{
+  stats.hits = 0;
+  stats.misses = 0;
+  stats.bypasses = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/* End of TextCache.cpp */
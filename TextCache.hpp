@@ -0,0 +1,81 @@
+/*
+ * TextCache.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The TextCache is a singleton class which keeps rendered runs of text in an
+ * atlas surface, so that text which is drawn over and over again only has to
+ * go through the font rasterizer once. Entries are keyed on the text, font and
+ * pen together, so a change to any of them is simply a different entry; the
+ * least recently used entry makes way when the atlas is full.
+ */
+
+#ifndef   _TEXTCACHE_HPP_
+#define   _TEXTCACHE_HPP_
+
+/* The atlas is a column of fixed size slots; anything that doesn't fit in */
+/* one, or is too long to bother keying, is just drawn directly.           */
+#ifdef    PICO_BUILD
+#define TEXTCACHE_SLOTS         8
+#else
+#define TEXTCACHE_SLOTS         16
+#endif /* PICO_BUILD */
+#define TEXTCACHE_SLOT_WIDTH    128
+#define TEXTCACHE_SLOT_HEIGHT   16
+#define TEXTCACHE_MAX_LENGTH    32
+
+/* Text is only cached the second time it's seen in a short while; text in */
+/* a pen that changes every frame would otherwise churn through the atlas. */
+#define TEXTCACHE_SEEN          8
+
+typedef struct
+{
+  uint32_t              hash;
+  char                  text[TEXTCACHE_MAX_LENGTH];
+  const blit::Font     *font;
+  blit::Pen             pen;
+  bool                  variable;
+  blit::Size            size;
+  uint32_t              last_used;
+  bool                  valid;
+} textcache_entry_t;
+
+typedef struct
+{
+  uint32_t              hits;
+  uint32_t              misses;
+  uint32_t              bypasses;
+} textcache_stats_t;
+
+class TextCache
+{
+private:
+                        TextCache( void );
+  uint8_t              *atlas_data;
+  blit::Surface        *atlas;
+  bool                  atlas_failed;
+  textcache_entry_t     entries[TEXTCACHE_SLOTS];
+  uint32_t              seen[TEXTCACHE_SEEN];
+  uint8_t               seen_next;
+  uint32_t              clock;
+  textcache_stats_t     stats;
+
+  bool                  prepare( void );
+  bool                  admit( uint32_t );
+  textcache_entry_t    *find( uint32_t, const char *, const blit::Font &, bool );
+  textcache_entry_t    *fill( uint32_t, const char *, const blit::Font &, bool, blit::Size );
+
+public:
+  static TextCache     &get_instance( void );
+  void                  text( const char *, const blit::Font &, const blit::Point &,
+                              bool = true, blit::TextAlign = blit::TextAlign::top_left );
+  const textcache_stats_t *get_stats( void );
+  void                  reset_stats( void );
+};
+
+
+#endif /* _TEXTCACHE_HPP_ */
+
+/* End of TextCache.hpp */
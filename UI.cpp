@@ -0,0 +1,906 @@
+/*
+ * UI.cpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The UI is a small set of retained widgets for the menu-like screens. The
+ * widgets only measure their text when it changes, and only mark themselves
+ * dirty when something about them actually looks different; the panel then
+ * puts the backdrop back behind just those, and draws them again.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "32blit.hpp"
+#include "32blox.hpp"
+
+#include "UI.hpp"
+
+
+/* Functions. */
+
+/*
+ * merge - the smallest rectangle covering both of the ones given; an empty
+ *         one doesn't count for anything.
+ */
+
+static blit::Rect merge( const blit::Rect &p_first, const blit::Rect &p_second )
+{
+  if ( p_first.empty() )
+  {
+    return p_second;
+  }
+  if ( p_second.empty() )
+  {
+    return p_first;
+  }
+
+  int32_t l_left = std::min( p_first.x, p_second.x );
+  int32_t l_top = std::min( p_first.y, p_second.y );
+  int32_t l_right = std::max( p_first.x + p_first.w, p_second.x + p_second.w );
+  int32_t l_bottom = std::max( p_first.y + p_first.h, p_second.y + p_second.h );
+  return blit::Rect( l_left, l_top, l_right - l_left, l_bottom - l_top );
+}
+
+
+/*
+ * same_pen - checks if two pens would draw the same thing.
+ */
+
+static bool same_pen( const blit::Pen &p_first, const blit::Pen &p_second )
+{
+  return p_first.r == p_second.r && p_first.g == p_second.g &&
+         p_first.b == p_second.b && p_first.a == p_second.a;
+}
+
+
+/*
+ * UIWidget constructor - a new widget has never been drawn, so it's dirty.
+ */
+
+UIWidget::UIWidget( void )
+{
+  bounds = blit::Rect( 0, 0, 0, 0 );
+  drawn = blit::Rect( 0, 0, 0, 0 );
+  dirty = true;
+  laid_out = false;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * changed - flags that the widget needs drawing again.
+ *
+ * bool - true if the change might have moved it, so it needs laying out too
+ */
+
+void UIWidget::changed( bool p_relayout )
+{
+  dirty = true;
+  if ( p_relayout )
+  {
+    laid_out = false;
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * is_dirty - checks if the widget needs drawing again.
+ */
+
+bool UIWidget::is_dirty( void )
+{
+  return dirty;
+}
+
+
+/*
+ * get_bounds - where the widget is now, laying it out first if it's changed.
+ */
+
+blit::Rect UIWidget::get_bounds( void )
+{
+  if ( !laid_out )
+  {
+    layout();
+    laid_out = true;
+  }
+  return bounds;
+}
+
+
+/*
+ * get_drawn - where the widget was when it was last drawn; the backdrop has
+ *             to be put back over there, if it's since moved.
+ */
+
+blit::Rect UIWidget::get_drawn( void )
+{
+  return drawn;
+}
+
+
+/*
+ * clean - called once the widget has been drawn.
+ */
+
+void UIWidget::clean( void )
+{
+  dirty = false;
+  drawn = get_bounds();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * UILabel constructor - an empty label, until it's given something to say.
+ */
+
+UILabel::UILabel( void )
+{
+  text[0] = '\0';
+  font = nullptr;
+  anchor = blit::Point( 0, 0 );
+  align = blit::TextAlign::top_left;
+  variable = true;
+  pen = blit::Pen( 255, 255, 255 );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * init - sets up where, and in what font, the label goes.
+ *
+ * const blit::Font & - the font to draw in
+ * blit::Point        - the point the text is aligned to
+ * blit::TextAlign    - how the text is aligned to it
+ * bool               - true if the font is variable width
+ */
+
+void UILabel::init( const blit::Font &p_font, blit::Point p_anchor, blit::TextAlign p_align, bool p_variable )
+{
+  font = &p_font;
+  anchor = p_anchor;
+  align = p_align;
+  variable = p_variable;
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_text - changes what the label says; if it's no different, nothing
+ *            needs doing at all.
+ *
+ * const char * - the new text
+ */
+
+void UILabel::set_text( const char *p_text )
+{
+  if ( strncmp( text, p_text, UI_MAX_TEXT - 1 ) == 0 )
+  {
+    return;
+  }
+
+  strncpy( text, p_text, UI_MAX_TEXT - 1 );
+  text[UI_MAX_TEXT - 1] = '\0';
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_pen - changes the colour of the label; it doesn't move, though.
+ *
+ * blit::Pen - the new pen
+ */
+
+void UILabel::set_pen( blit::Pen p_pen )
+{
+  if ( same_pen( pen, p_pen ) )
+  {
+    return;
+  }
+
+  pen = p_pen;
+  changed( false );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * layout - measures the text, and lines it up against the anchor the same
+ *          way that blit's own text rendering would.
+ */
+
+void UILabel::layout( void )
+{
+  if ( font == nullptr || text[0] == '\0' )
+  {
+    bounds = blit::Rect( anchor, blit::Size( 0, 0 ) );
+    return;
+  }
+
+  blit::Size  l_size = blit::screen.measure_text( text, *font, variable );
+  blit::Point l_point = anchor;
+
+  if ( align & blit::TextAlign::center_h )
+  {
+    l_point.x += ( 0 - l_size.w ) / 2;
+  }
+  if ( align & blit::TextAlign::right )
+  {
+    l_point.x -= l_size.w;
+  }
+  if ( align & blit::TextAlign::center_v )
+  {
+    l_point.y += ( 0 - l_size.h ) / 2;
+  }
+  if ( align & blit::TextAlign::bottom )
+  {
+    l_point.y -= l_size.h;
+  }
+  bounds = blit::Rect( l_point, l_size );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * draw - draws the label, from where it's already been laid out.
+ */
+
+void UILabel::draw( void )
+{
+  blit::Rect l_bounds = get_bounds();
+  if ( l_bounds.empty() )
+  {
+    return;
+  }
+
+  blit::screen.pen = pen;
+  text_cache.text( text, *font, l_bounds.tl(), variable, blit::TextAlign::top_left );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * UIImage constructor - with nothing to show.
+ */
+
+UIImage::UIImage( void )
+{
+  image = nullptr;
+  position = blit::Point( 0, 0 );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * init - sets up the image, and where it goes.
+ *
+ * PackedImage * - the image
+ * blit::Point   - where the top left of the image goes
+ */
+
+void UIImage::init( PackedImage *p_image, blit::Point p_position )
+{
+  image = p_image;
+  position = p_position;
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * layout / draw - the image is drawn whole.
+ */
+
+void UIImage::layout( void )
+{
+  if ( image == nullptr )
+  {
+    bounds = blit::Rect( position, blit::Size( 0, 0 ) );
+    return;
+  }
+  bounds = blit::Rect( position, image->get_bounds() );
+}
+void UIImage::draw( void )
+{
+  if ( image != nullptr )
+  {
+    image->blit( &blit::screen, blit::Rect( blit::Point( 0, 0 ), image->get_bounds() ), position );
+  }
+}
+
+
+/*
+ * UIToggle constructor - starts off, and without focus.
+ */
+
+UIToggle::UIToggle( void )
+{
+  on_text = "";
+  off_text = "";
+  plain_pen = blit::Pen( 255, 255, 255 );
+  focus_pen = blit::Pen( 255, 255, 255 );
+  state = false;
+  focused = false;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * init - sets up the caption and value; both are aligned by their left edge,
+ *        vertically centred on their points.
+ *
+ * const blit::Font & - the font to draw in
+ * const char *       - the caption text
+ * blit::Point        - where the caption goes
+ * blit::Point        - where the value goes
+ * const char *       - the value text when it's on
+ * const char *       - the value text when it's off
+ */
+
+void UIToggle::init( const blit::Font &p_font, const char *p_caption, blit::Point p_caption_point,
+                     blit::Point p_value_point, const char *p_on, const char *p_off )
+{
+  on_text = p_on;
+  off_text = p_off;
+
+  caption.init( p_font, p_caption_point, blit::TextAlign::center_left );
+  caption.set_text( p_caption );
+  value.init( p_font, p_value_point, blit::TextAlign::center_left );
+  value.set_text( state ? on_text : off_text );
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_state - switches the toggle on or off.
+ *
+ * bool - true to switch it on
+ */
+
+void UIToggle::set_state( bool p_state )
+{
+  if ( state == p_state )
+  {
+    return;
+  }
+
+  state = p_state;
+  value.set_text( state ? on_text : off_text );
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_focus - gives the toggle focus, which highlights the value.
+ *
+ * bool - true if the toggle has focus
+ */
+
+void UIToggle::set_focus( bool p_focused )
+{
+  if ( focused == p_focused )
+  {
+    return;
+  }
+
+  focused = p_focused;
+  value.set_pen( focused ? focus_pen : plain_pen );
+  changed( false );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_pens - sets the pens to draw in; the focus one is usually pulsing, so
+ *            this only dirties the toggle if it's the one with the focus.
+ *
+ * blit::Pen - the plain pen, for everything else
+ * blit::Pen - the pen for the value, when the toggle has focus
+ */
+
+void UIToggle::set_pens( blit::Pen p_plain, blit::Pen p_focus )
+{
+  plain_pen = p_plain;
+  focus_pen = p_focus;
+
+  caption.set_pen( plain_pen );
+  value.set_pen( focused ? focus_pen : plain_pen );
+  if ( caption.is_dirty() || value.is_dirty() )
+  {
+    changed( false );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * layout / draw / clean - the toggle is just its two labels.
+ */
+
+void UIToggle::layout( void )
+{
+  bounds = merge( caption.get_bounds(), value.get_bounds() );
+}
+void UIToggle::draw( void )
+{
+  caption.draw();
+  value.draw();
+}
+void UIToggle::clean( void )
+{
+  caption.clean();
+  value.clean();
+  UIWidget::clean();
+}
+
+
+/*
+ * UITable constructor - with no rows in it.
+ */
+
+UITable::UITable( void )
+{
+  row_count = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * init - sets up where the rows of the table go.
+ *
+ * const blit::Font & - the font to draw in
+ * blit::Point        - the point the first row is aligned to
+ * uint8_t            - the distance between each row
+ * blit::TextAlign    - how each row is aligned
+ * bool               - true if the font is variable width
+ */
+
+void UITable::init( const blit::Font &p_font, blit::Point p_anchor, uint8_t p_spacing,
+                    blit::TextAlign p_align, bool p_variable )
+{
+  for ( uint8_t l_index = 0; l_index < UI_MAX_ROWS; l_index++ )
+  {
+    rows[l_index].init( p_font, p_anchor + blit::Point( 0, l_index * p_spacing ), p_align, p_variable );
+  }
+  row_count = 0;
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_row_count - sets how many rows of the table are shown.
+ *
+ * uint8_t - the number of rows
+ */
+
+void UITable::set_row_count( uint8_t p_count )
+{
+  if ( p_count > UI_MAX_ROWS )
+  {
+    p_count = UI_MAX_ROWS;
+  }
+  if ( row_count == p_count )
+  {
+    return;
+  }
+
+  row_count = p_count;
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_row - fills in a row of the table.
+ *
+ * uint8_t      - the row to fill in
+ * const char * - the text to put in it
+ * blit::Pen    - the pen to draw it in
+ */
+
+void UITable::set_row( uint8_t p_row, const char *p_text, blit::Pen p_pen )
+{
+  /* Sanity check the row. */
+  if ( p_row >= UI_MAX_ROWS )
+  {
+    return;
+  }
+
+  rows[p_row].set_text( p_text );
+  rows[p_row].set_pen( p_pen );
+  if ( rows[p_row].is_dirty() )
+  {
+    changed();
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * layout / draw / clean - the table is just the labels in each shown row.
+ */
+
+void UITable::layout( void )
+{
+  bounds = blit::Rect( 0, 0, 0, 0 );
+  for ( uint8_t l_index = 0; l_index < row_count; l_index++ )
+  {
+    bounds = merge( bounds, rows[l_index].get_bounds() );
+  }
+}
+void UITable::draw( void )
+{
+  for ( uint8_t l_index = 0; l_index < row_count; l_index++ )
+  {
+    rows[l_index].draw();
+  }
+}
+void UITable::clean( void )
+{
+  for ( uint8_t l_index = 0; l_index < UI_MAX_ROWS; l_index++ )
+  {
+    rows[l_index].clean();
+  }
+  UIWidget::clean();
+}
+
+
+/*
+ * UITextField constructor - empty, with the cursor at the start.
+ */
+
+UITextField::UITextField( void )
+{
+  text[0] = '\0';
+  length = 0;
+  cursor = 0;
+  cursor_pen = blit::Pen( 255, 255, 255 );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * init - sets up where the field goes; it's centred on the point given.
+ *
+ * const blit::Font & - the font to draw in
+ * blit::Point        - the centre of the field
+ */
+
+void UITextField::init( const blit::Font &p_font, blit::Point p_centre )
+{
+  label.init( p_font, p_centre, blit::TextAlign::center_center );
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_text - changes the contents of the field; it's shown with a space
+ *            between each character, to leave room for the cursor box.
+ *
+ * const char * - the new text
+ */
+
+void UITextField::set_text( const char *p_text )
+{
+  char l_spaced[UI_MAX_TEXT];
+
+  if ( strncmp( text, p_text, UI_MAX_TEXT / 2 - 1 ) == 0 )
+  {
+    return;
+  }
+
+  strncpy( text, p_text, UI_MAX_TEXT / 2 - 1 );
+  text[UI_MAX_TEXT / 2 - 1] = '\0';
+  length = strlen( text );
+
+  for ( uint8_t l_index = 0; l_index < length; l_index++ )
+  {
+    l_spaced[l_index * 2] = text[l_index];
+    l_spaced[l_index * 2 + 1] = ' ';
+  }
+  l_spaced[length > 0 ? length * 2 - 1 : 0] = '\0';
+  label.set_text( l_spaced );
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_cursor - moves the cursor box to a different character.
+ *
+ * uint8_t - the character the cursor is on
+ */
+
+void UITextField::set_cursor( uint8_t p_cursor )
+{
+  if ( cursor == p_cursor )
+  {
+    return;
+  }
+
+  cursor = p_cursor;
+  changed();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_pens - sets the pens to draw the text, and the cursor box, in.
+ *
+ * blit::Pen - the pen for the text
+ * blit::Pen - the pen for the cursor box
+ */
+
+void UITextField::set_pens( blit::Pen p_text, blit::Pen p_cursor )
+{
+  label.set_pen( p_text );
+  if ( label.is_dirty() || !same_pen( cursor_pen, p_cursor ) )
+  {
+    cursor_pen = p_cursor;
+    changed( false );
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * layout - the field covers the text, and the cursor box which sticks out
+ *          above and below it; each character (and its space) is 32 wide.
+ */
+
+void UITextField::layout( void )
+{
+  blit::Rect l_text = label.get_bounds();
+  blit::Rect l_box( l_text.x + cursor * 32 - 5, l_text.y - 9, 24, 33 );
+
+  bounds = merge( l_text, l_box );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * draw - draws the text, and then the box around the current character.
+ */
+
+void UITextField::draw( void )
+{
+  label.draw();
+
+  blit::Rect  l_text = label.get_bounds();
+  blit::Point l_char_box( l_text.x + cursor * 32 - 5, l_text.y - 9 );
+
+  blit::screen.pen = cursor_pen;
+  blit::screen.h_span( l_char_box, 24 );
+  blit::screen.h_span( l_char_box + blit::Point( 0, 32 ), 24 );
+  blit::screen.v_span( l_char_box, 32 );
+  blit::screen.v_span( l_char_box + blit::Point( 23, 0 ), 32 );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * clean - the field is clean once its label is.
+ */
+
+void UITextField::clean( void )
+{
+  label.clean();
+  UIWidget::clean();
+}
+
+
+/*
+ * UIPanel constructor - an empty panel, over nothing in particular.
+ */
+
+UIPanel::UIPanel( void )
+{
+  backdrop_type = BACKDROP_MAX;
+  offset = 0;
+  drawn_offset = 0;
+  widget_count = 0;
+  valid = false;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * init - empties the panel, ready for a screen's widgets to be added.
+ *
+ * backdrop_t - the backdrop to draw behind them
+ */
+
+void UIPanel::init( backdrop_t p_type )
+{
+  backdrop_type = p_type;
+  offset = 0;
+  widget_count = 0;
+  dirty.set_bounds( blit::screen.bounds );
+  valid = false;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * add - adds a widget to the panel; the panel doesn't own it, it just draws
+ *       it, so it has to stay around for as long as the panel does.
+ *
+ * UIWidget * - the widget to add
+ */
+
+void UIPanel::add( UIWidget *p_widget )
+{
+  if ( widget_count < UI_MAX_WIDGETS )
+  {
+    widgets[widget_count++] = p_widget;
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_offset - scrolls the backdrop; there's no way to do that without
+ *              drawing everything again, so the next render will.
+ *
+ * uint16_t - how far the backdrop has scrolled
+ */
+
+void UIPanel::set_offset( uint16_t p_offset )
+{
+  offset = p_offset;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * invalidate - something else has drawn over the screen, so the next render
+ *              has to start from scratch.
+ */
+
+void UIPanel::invalidate( void )
+{
+  valid = false;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * render - draws the panel. If the screen can't be trusted, or the backdrop
+ *          has scrolled, that means everything; otherwise the backdrop is
+ *          put back wherever a dirty widget was or now is, and anything in
+ *          those areas is drawn again.
+ */
+
+void UIPanel::render( void )
+{
+  uint8_t l_index;
+
+  if ( !valid || offset != drawn_offset )
+  {
+    backdrop.render( backdrop_type, offset );
+    for ( l_index = 0; l_index < widget_count; l_index++ )
+    {
+      widgets[l_index]->draw();
+      widgets[l_index]->clean();
+    }
+    drawn_offset = offset;
+    valid = true;
+    return;
+  }
+
+  /* Work out where needs redrawing. */
+  dirty.clear();
+  for ( l_index = 0; l_index < widget_count; l_index++ )
+  {
+    if ( widgets[l_index]->is_dirty() )
+    {
+      dirty.add( widgets[l_index]->get_drawn() );
+      dirty.add( widgets[l_index]->get_bounds() );
+    }
+  }
+  if ( dirty.get_count() == 0 )
+  {
+    return;
+  }
+
+  /* Put the backdrop back there, and draw whatever's in the way. */
+  for ( l_index = 0; l_index < dirty.get_count(); l_index++ )
+  {
+    backdrop.render( backdrop_type, offset, dirty.get_rect( l_index ) );
+  }
+  for ( l_index = 0; l_index < widget_count; l_index++ )
+  {
+    if ( widgets[l_index]->is_dirty() || dirty.intersects( widgets[l_index]->get_bounds() ) )
+    {
+      widgets[l_index]->draw();
+      widgets[l_index]->clean();
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/* End of UI.cpp */
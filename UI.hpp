@@ -0,0 +1,185 @@
+/*
+ * UI.hpp - part of 32Blox (revised edition!)
+ *
+ * Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+ *
+ * This file is released under the MIT License; see LICENSE for details
+ *
+ * The UI is a small set of retained widgets - images, labels, toggles, tables
+ * and a text field - for the menu-like screens. Each widget keeps its own layout,
+ * and only works it out again when its contents change; a panel holds them
+ * together over a backdrop, and only redraws the ones that have changed.
+ */
+
+#ifndef   _UI_HPP_
+#define   _UI_HPP_
+
+#include "Backdrop.hpp"
+#include "DirtyRects.hpp"
+#include "PackedImage.hpp"
+#include "TextCache.hpp"
+
+#define UI_MAX_TEXT       40
+#define UI_MAX_ROWS       10
+#define UI_MAX_WIDGETS    16
+
+
+/* The base of all widgets, which just looks after the dirty flag and layout. */
+
+class UIWidget
+{
+protected:
+  TextCache            &text_cache = TextCache::get_instance();
+  blit::Rect            bounds;
+  blit::Rect            drawn;
+  bool                  dirty;
+  bool                  laid_out;
+
+  void                  changed( bool = true );
+
+public:
+                        UIWidget( void );
+  virtual              ~UIWidget( void ) {}
+  virtual void          layout( void ) = 0;
+  virtual void          draw( void ) = 0;
+  bool                  is_dirty( void );
+  blit::Rect            get_bounds( void );
+  blit::Rect            get_drawn( void );
+  virtual void          clean( void );
+};
+
+
+/* A single run of text, in a single pen. */
+
+class UILabel : public UIWidget
+{
+private:
+  char                  text[UI_MAX_TEXT];
+  const blit::Font     *font;
+  blit::Point           anchor;
+  blit::TextAlign       align;
+  bool                  variable;
+  blit::Pen             pen;
+
+public:
+                        UILabel( void );
+  void                  init( const blit::Font &, blit::Point, blit::TextAlign, bool = true );
+  void                  set_text( const char * );
+  void                  set_pen( blit::Pen );
+  void                  layout( void );
+  void                  draw( void );
+};
+
+
+/* A picture, from a packed image. */
+
+class UIImage : public UIWidget
+{
+private:
+  PackedImage          *image;
+  blit::Point           position;
+
+public:
+                        UIImage( void );
+  void                  init( PackedImage *, blit::Point );
+  void                  layout( void );
+  void                  draw( void );
+};
+
+
+/* A caption with an on/off value beside it, highlighted when it has focus. */
+
+class UIToggle : public UIWidget
+{
+private:
+  UILabel               caption;
+  UILabel               value;
+  const char           *on_text;
+  const char           *off_text;
+  blit::Pen             plain_pen;
+  blit::Pen             focus_pen;
+  bool                  state;
+  bool                  focused;
+
+public:
+                        UIToggle( void );
+  void                  init( const blit::Font &, const char *, blit::Point, blit::Point,
+                              const char *, const char * );
+  void                  set_state( bool );
+  void                  set_focus( bool );
+  void                  set_pens( blit::Pen, blit::Pen );
+  void                  layout( void );
+  void                  draw( void );
+  void                  clean( void );
+};
+
+
+/* Rows of text, one under the other, each in its own pen. */
+
+class UITable : public UIWidget
+{
+private:
+  UILabel               rows[UI_MAX_ROWS];
+  uint8_t               row_count;
+
+public:
+                        UITable( void );
+  void                  init( const blit::Font &, blit::Point, uint8_t, blit::TextAlign, bool = true );
+  void                  set_row_count( uint8_t );
+  void                  set_row( uint8_t, const char *, blit::Pen );
+  void                  layout( void );
+  void                  draw( void );
+  void                  clean( void );
+};
+
+
+/* A line of characters, spaced out, with a box around the one being edited. */
+
+class UITextField : public UIWidget
+{
+private:
+  UILabel               label;
+  char                  text[UI_MAX_TEXT];
+  uint8_t               length;
+  uint8_t               cursor;
+  blit::Pen             cursor_pen;
+
+public:
+                        UITextField( void );
+  void                  init( const blit::Font &, blit::Point );
+  void                  set_text( const char * );
+  void                  set_cursor( uint8_t );
+  void                  set_pens( blit::Pen, blit::Pen );
+  void                  layout( void );
+  void                  draw( void );
+  void                  clean( void );
+};
+
+
+/* A screen full of widgets, over a backdrop. */
+
+class UIPanel
+{
+private:
+  Backdrop             &backdrop = Backdrop::get_instance();
+  backdrop_t            backdrop_type;
+  uint16_t              offset;
+  uint16_t              drawn_offset;
+  UIWidget             *widgets[UI_MAX_WIDGETS];
+  uint8_t               widget_count;
+  DirtyRects            dirty;
+  bool                  valid;
+
+public:
+                        UIPanel( void );
+  void                  init( backdrop_t );
+  void                  add( UIWidget * );
+  void                  set_offset( uint16_t );
+  void                  invalidate( void );
+  void                  render( void );
+};
+
+
+#endif /* _UI_HPP_ */
+
+/* End of UI.hpp */
@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+#
+# compile_levels.py - part of 32Blox (revised edition!)
+#
+# Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+#
+# This file is released under the MIT License; see LICENSE for details
+#
+# Compiles level CSV files into the packed binary form that Level loads. The
+# levels are checked over as they're compiled; anything malformed stops the
+# build, rather than turning up as a strange level in the game.
+#
+# The compiled layout, all little endian:
+#
+#   uint8   format version
+#   uint8   width, in bricks
+#   uint8   height, in bricks
+#   uint8   side margin, in pixels
+#   uint16  breakable brick count
+#   uint16  total hit points of the breakable bricks
+#   uint16  row masks[height]           - bit n is column n
+#   uint16  column masks[width]         - bit n is row n
+#   uint8   bricks[(width * height + 1) / 2]
+#
+# The bricks are two to a byte, row by row, the first in the low nibble. A
+# brick is 0 for none, 1 to 7 for the hits it takes to break, or 8 for an
+# unbreakable one.
+#
+# The levels themselves, and the sets they're in, are listed in levels.yml.
+# Alongside the compiled levels, this writes out the level registry; a table
+# of every level in each set, with where it is and what's in it, and which
+# set each target plays. It's all constexpr, so Level can check it over at
+# compile time, and just index into it at runtime.
+#
+# It can also write a single set out as a level pack, for LevelPack to read
+# from the SD card (or the desktop) instead of playing the built-in levels;
+# see LevelPack.cpp for the layout.
+#
+# Usage: compile_levels.py <manifest> --output <output base> <set> ...
+#        compile_levels.py <manifest> --pack <pack file> <set>
+#        compile_levels.py <manifest> --depends <set> ...
+#
+# This writes <output base>.cpp and <output base>.hpp, with just the sets
+# named; any target without a set of its own plays the first one. Given
+# --depends, it just lists the level files of those sets, for CMake.
+#
+# Sets can be no bigger than the board Level holds; that's MAX_BOARD_WIDTH
+# by MAX_BOARD_HEIGHT in Level.hpp, which CMake passes in with --max-size.
+
+import argparse
+import os
+import sys
+
+try:
+    import yaml
+except ImportError:
+    sys.exit("compile_levels.py: PyYAML is needed to read the manifest")
+
+
+LEVEL_VERSION = 1
+MAX_WIDTH = 10      # MAX_BOARD_WIDTH in Level.hpp
+MAX_HEIGHT = 15     # MAX_BOARD_HEIGHT in Level.hpp
+BRICK_UNBREAKABLE = 8
+MAX_LEVELS = 255
+PACK_MAGIC = b"32BP"
+PACK_VERSION = 1
+PACK_HEADER_SIZE = 12
+PACK_ENTRY_SIZE = 6
+MAX_PACK_LEVELS = 0xFFFF
+
+# The targets, in the same order as target_type_t.
+TARGETS = ["32blit", "picosystem", "sdl"]
+
+
+def fail(message):
+    sys.exit("compile_levels.py: " + message)
+
+
+def read_level(path, width, height):
+    """Reads and checks a level CSV, returning the rows of bricks."""
+    try:
+        with open(path, "r") as source:
+            lines = source.read().splitlines()
+    except (IOError, OSError) as error:
+        fail("unable to read %s: %s" % (path, error))
+
+    # Trailing blank lines are harmless; any others are a mistake.
+    while lines and not lines[-1].strip():
+        lines.pop()
+    if not lines:
+        fail("%s: the level is empty" % path)
+    if len(lines) > height:
+        fail("%s: %d rows, but levels are only %d high" % (path, len(lines), height))
+
+    rows = []
+    for number, line in enumerate(lines, 1):
+        cells = [cell.strip() for cell in line.split(",")]
+        if len(cells) != width:
+            fail("%s:%d: %d bricks, but levels are %d wide" % (path, number, len(cells), width))
+        row = []
+        for cell in cells:
+            if not cell.isdigit() or int(cell) > BRICK_UNBREAKABLE:
+                fail("%s:%d: '%s' is not a brick (0 to %d)" % (path, number, cell, BRICK_UNBREAKABLE))
+            row.append(int(cell))
+        rows.append(row)
+
+    # Anything below the rows given is empty.
+    while len(rows) < height:
+        rows.append([0] * width)
+
+    return rows
+
+
+def compile_level(rows, width, height, margin):
+    """Works out everything about a level, and packs it up; returns the packed
+    level, and the details of it for the registry."""
+    breakable = 0
+    hit_points = 0
+    row_masks = [0] * height
+    column_masks = [0] * width
+    cells = []
+
+    for row in range(height):
+        for column in range(width):
+            brick = rows[row][column]
+            cells.append(brick)
+            if brick > 0:
+                row_masks[row] |= 1 << column
+                column_masks[column] |= 1 << row
+            if 0 < brick < BRICK_UNBREAKABLE:
+                breakable += 1
+                hit_points += brick
+
+    packed = bytearray([LEVEL_VERSION, width, height, margin])
+    packed.extend(breakable.to_bytes(2, "little"))
+    packed.extend(hit_points.to_bytes(2, "little"))
+    for mask in row_masks + column_masks:
+        packed.extend(mask.to_bytes(2, "little"))
+
+    if len(cells) % 2:
+        cells.append(0)
+    for index in range(0, len(cells), 2):
+        packed.append(cells[index] | (cells[index + 1] << 4))
+
+    return packed, (width, height, margin, breakable, hit_points)
+
+
+def read_manifest(path, names, max_size=(MAX_WIDTH, MAX_HEIGHT), max_levels=MAX_LEVELS):
+    """Reads the manifest, returning the details of the sets named."""
+    try:
+        with open(path, "r") as source:
+            manifest = yaml.safe_load(source)
+    except (IOError, OSError, yaml.YAMLError) as error:
+        fail("unable to read %s: %s" % (path, error))
+    if not isinstance(manifest, dict):
+        fail("%s: there are no level sets in it" % path)
+
+    base = os.path.dirname(os.path.abspath(path))
+    sets = []
+    claimed = {}
+    for name in names:
+        details = manifest.get(name)
+        if not isinstance(details, dict):
+            fail("%s: there is no level set called %s" % (path, name))
+        if not name.isidentifier():
+            fail("%s: %s can't be used as a name" % (path, name))
+
+        try:
+            width = int(details["width"])
+            height = int(details["height"])
+            margin = int(details.get("margin", 0))
+            targets = list(details.get("targets", []))
+            levels = [os.path.join(base, level) for level in details["levels"]]
+        except (KeyError, TypeError, ValueError) as error:
+            fail("%s: set %s is incomplete: %s" % (path, name, error))
+
+        if not 1 <= width <= max_size[0] or not 1 <= height <= max_size[1]:
+            fail("%s: set %s is %dx%d bricks, but the game can only hold %dx%d" %
+                 ((path, name, width, height) + max_size))
+        if not 0 <= margin <= 255:
+            fail("%s: set %s needs a margin between 0 and 255" % (path, name))
+        if not 1 <= len(levels) <= max_levels:
+            fail("%s: set %s needs between 1 and %d levels" % (path, name, max_levels))
+        for target in targets:
+            if target not in TARGETS:
+                fail("%s: set %s is for %s, which isn't a target" % (path, name, target))
+            if target in claimed:
+                fail("%s: %s and %s are both for %s" % (path, claimed[target], name, target))
+            claimed[target] = name
+
+        sets.append({"name": name, "width": width, "height": height, "margin": margin,
+                     "targets": targets, "levels": levels})
+
+    return sets
+
+
+def write_source(base, sets):
+    """Writes out the compiled levels as C++ arrays, and the registry of them."""
+    with open(base + ".hpp", "w") as output:
+        output.write("// Generated by compile_levels.py; do not edit.\n")
+        output.write("//\n// Level.hpp, and 32blox.hpp before it, need to be included first.\n\n")
+        output.write("#pragma once\n\n#include <cstdint>\n\n")
+
+        for level_set in sets:
+            prefix = "a_%s_level_" % level_set["name"]
+            for number, (packed, info) in enumerate(level_set["compiled"], 1):
+                output.write("extern const uint8_t %s%02d[];\n" % (prefix, number))
+            output.write("\nconstexpr level_info_t a_%s_levels[] =\n{\n" % level_set["name"])
+            for number, (packed, info) in enumerate(level_set["compiled"], 1):
+                output.write("  { %s%02d, %d, %d, %d, %d, %d, %d },\n" %
+                             ((prefix, number, len(packed)) + info))
+            output.write("};\n")
+            output.write("constexpr level_set_t a_%s_set = { a_%s_levels, %d };\n\n" %
+                         (level_set["name"], level_set["name"], len(level_set["compiled"])))
+
+        output.write("static_assert( TARGET_32BLIT == 0 && TARGET_PICOSYSTEM == 1 && TARGET_SDL == 2,\n")
+        output.write("               \"the level registry is indexed by target_type_t\" );\n\n")
+        output.write("constexpr const level_set_t *a_level_registry[] =\n{\n")
+        for target in TARGETS:
+            owner = [level_set for level_set in sets if target in level_set["targets"]]
+            if owner:
+                output.write("  &a_%s_set,   /* %s */\n" % (owner[0]["name"], target))
+            else:
+                output.write("  &a_%s_set,   /* %s, which has no set in this build */\n" %
+                             (sets[0]["name"], target))
+        output.write("};\n")
+
+    with open(base + ".cpp", "w") as output:
+        output.write("// Generated by compile_levels.py; do not edit.\n\n")
+        output.write("#include <cstdint>\n\n")
+        for level_set in sets:
+            prefix = "a_%s_level_" % level_set["name"]
+            for number, (packed, info) in enumerate(level_set["compiled"], 1):
+                output.write("extern const uint8_t %s%02d[];\n" % (prefix, number))
+                output.write("const uint8_t %s%02d[] = {\n" % (prefix, number))
+                for start in range(0, len(packed), 16):
+                    row = ", ".join("0x%02x" % byte for byte in packed[start:start + 16])
+                    output.write("  %s,\n" % row)
+                output.write("};\n\n")
+
+
+def write_pack(path, level_set):
+    """Writes out a single set as a level pack; a header, an index of where
+    each level is, and then the levels themselves."""
+    compiled = [packed for packed, info in level_set["compiled"]]
+
+    pack = bytearray(PACK_MAGIC)
+    pack.extend([PACK_VERSION, LEVEL_VERSION, level_set["width"], level_set["height"],
+                 level_set["margin"], 0])
+    pack.extend(len(compiled).to_bytes(2, "little"))
+
+    offset = PACK_HEADER_SIZE + len(compiled) * PACK_ENTRY_SIZE
+    for packed in compiled:
+        pack.extend(offset.to_bytes(4, "little"))
+        pack.extend(len(packed).to_bytes(2, "little"))
+        offset += len(packed)
+    for packed in compiled:
+        pack.extend(packed)
+
+    try:
+        with open(path, "wb") as output:
+            output.write(pack)
+    except (IOError, OSError) as error:
+        fail("unable to write %s: %s" % (path, error))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile levels for 32Blox.")
+    parser.add_argument("manifest", help="the manifest listing the level sets")
+    action = parser.add_mutually_exclusive_group(required=True)
+    action.add_argument("--output", help="base name of the files to write")
+    action.add_argument("--pack", help="name of the level pack to write")
+    action.add_argument("--depends", action="store_true", help="just list the level files")
+    parser.add_argument("--max-size", default="%dx%d" % (MAX_WIDTH, MAX_HEIGHT),
+                        help="the largest board the game can hold, as WIDTHxHEIGHT")
+    parser.add_argument("sets", nargs="+", help="the level sets to compile")
+    args = parser.parse_args()
+
+    try:
+        max_size = tuple(int(size) for size in args.max_size.lower().split("x"))
+    except ValueError:
+        max_size = ()
+    if len(max_size) != 2 or min(max_size) < 1:
+        fail("--max-size should be WIDTHxHEIGHT, not %s" % args.max_size)
+
+    if args.pack and len(args.sets) != 1:
+        fail("a level pack holds just the one set")
+    sets = read_manifest(args.manifest, args.sets, max_size,
+                         MAX_PACK_LEVELS if args.pack else MAX_LEVELS)
+
+    if args.depends:
+        print(";".join(level for level_set in sets for level in level_set["levels"]))
+        return
+
+    for level_set in sets:
+        level_set["compiled"] = []
+        for path in level_set["levels"]:
+            rows = read_level(path, level_set["width"], level_set["height"])
+            level_set["compiled"].append(
+                compile_level(rows, level_set["width"], level_set["height"], level_set["margin"]))
+
+    if args.pack:
+        write_pack(args.pack, sets[0])
+    else:
+        write_source(args.output, sets)
+
+
+if __name__ == "__main__":
+    main()
+
+# End of compile_levels.py
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+#
+# pack_images.py - part of 32Blox (revised edition!)
+#
+# Copyright (C) 2020 Pete Favelle <32blit@ahnlak.com>
+#
+# This file is released under the MIT License; see LICENSE for details
+#
+# Packs images into the palettized, run length encoded format that PackedImage
+# unpacks at runtime. Each image is cut into horizontal bands, which are
+# encoded separately so that any one of them can be unpacked on its own.
+#
+# The packed layout, all little endian:
+#
+#   uint16  width
+#   uint16  height
+#   uint8   band height
+#   uint8   palette entries, less one
+#   uint8   palette[entries][4]          - RGBA
+#   uint32  band offsets[bands + 1]      - from the start of the band data
+#   uint8   band data
+#
+# Each band is a run of packets; a control byte under 128 is followed by that
+# many plus one literal indices, anything else is followed by a single index
+# which is repeated the control byte less 126 times.
+#
+# Usage: pack_images.py [--band N] <output base> <name>=<image> ...
+#
+# This writes <output base>.cpp and <output base>.hpp, declaring a_pack_<name>
+# for each image.
+
+import argparse
+import os
+import sys
+
+try:
+    from PIL import Image
+except ImportError:
+    sys.exit("pack_images.py: Pillow is needed to read the images")
+
+
+PREFIX = "a_pack_"
+MAX_LITERAL = 128
+MAX_REPEAT = 129
+
+
+def fail(message):
+    sys.exit("pack_images.py: " + message)
+
+
+def palettize(image, path):
+    """Returns the palette, and the image as a list of indices into it."""
+    palette = []
+    lookup = {}
+    indices = []
+
+    pixels = image.convert("RGBA").tobytes()
+    for offset in range(0, len(pixels), 4):
+        pixel = tuple(pixels[offset:offset + 4])
+        # Anything fully transparent is the same colour, as far as we care.
+        if pixel[3] == 0:
+            pixel = (0, 0, 0, 0)
+        if pixel not in lookup:
+            if len(palette) == 256:
+                fail("%s has more than 256 colours" % path)
+            lookup[pixel] = len(palette)
+            palette.append(pixel)
+        indices.append(lookup[pixel])
+
+    return palette, indices
+
+
+def encode(indices):
+    """Run length encodes a list of indices."""
+    packed = bytearray()
+    literal = []
+    offset = 0
+
+    while offset < len(indices):
+        # How far does this index repeat?
+        run = 1
+        while (offset + run < len(indices) and run < MAX_REPEAT and
+               indices[offset + run] == indices[offset]):
+            run += 1
+
+        # Runs of two or more are worth a packet of their own.
+        if run >= 2:
+            if literal:
+                packed.append(len(literal) - 1)
+                packed.extend(literal)
+                literal = []
+            packed.append(run + 126)
+            packed.append(indices[offset])
+            offset += run
+            continue
+
+        literal.append(indices[offset])
+        offset += 1
+        if len(literal) == MAX_LITERAL:
+            packed.append(len(literal) - 1)
+            packed.extend(literal)
+            literal = []
+
+    if literal:
+        packed.append(len(literal) - 1)
+        packed.extend(literal)
+
+    return packed
+
+
+def pack(path, band_height):
+    """Packs a single image, returning the bytes."""
+    try:
+        image = Image.open(path)
+    except (IOError, OSError) as error:
+        fail("unable to read %s: %s" % (path, error))
+
+    width, height = image.size
+    if width > 0xFFFF or height > 0xFFFF:
+        fail("%s is too big to pack" % path)
+    palette, indices = palettize(image, path)
+
+    # Encode each band separately, noting where each one starts.
+    bands = bytearray()
+    offsets = []
+    for top in range(0, height, band_height):
+        bottom = min(top + band_height, height)
+        offsets.append(len(bands))
+        bands.extend(encode(indices[top * width:bottom * width]))
+    offsets.append(len(bands))
+
+    packed = bytearray()
+    packed.extend(width.to_bytes(2, "little"))
+    packed.extend(height.to_bytes(2, "little"))
+    packed.append(band_height)
+    packed.append(len(palette) - 1)
+    for colour in palette:
+        packed.extend(colour)
+    for offset in offsets:
+        packed.extend(offset.to_bytes(4, "little"))
+    packed.extend(bands)
+
+    print("pack_images.py: %s %dx%d, %d colours, %d bytes (from %d)" %
+          (os.path.basename(path), width, height, len(palette), len(packed), width * height))
+    return packed
+
+
+def write_source(base, images):
+    """Writes out the packed images as C++ arrays."""
+    header = os.path.basename(base) + ".hpp"
+
+    with open(base + ".hpp", "w") as output:
+        output.write("// Generated by pack_images.py; do not edit.\n\n")
+        output.write("#pragma once\n\n#include <cstdint>\n\n")
+        for name, packed in images:
+            output.write("extern const uint8_t %s%s[];\n" % (PREFIX, name))
+            output.write("extern const uint32_t %s%s_length;\n" % (PREFIX, name))
+
+    with open(base + ".cpp", "w") as output:
+        output.write("// Generated by pack_images.py; do not edit.\n\n")
+        output.write("#include \"%s\"\n\n" % header)
+        for name, packed in images:
+            output.write("const uint8_t %s%s[] = {\n" % (PREFIX, name))
+            for start in range(0, len(packed), 16):
+                row = ", ".join("0x%02x" % byte for byte in packed[start:start + 16])
+                output.write("  %s,\n" % row)
+            output.write("};\n")
+            output.write("const uint32_t %s%s_length = %d;\n\n" % (PREFIX, name, len(packed)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack images for 32Blox.")
+    parser.add_argument("--band", type=int, default=8, help="height of each band, in lines")
+    parser.add_argument("output", help="base name of the files to write")
+    parser.add_argument("images", nargs="+", help="name=path of each image to pack")
+    args = parser.parse_args()
+
+    if args.band < 1 or args.band > 255:
+        fail("band height must be between 1 and 255")
+
+    images = []
+    for image in args.images:
+        name, separator, path = image.partition("=")
+        if not separator or not name.isidentifier():
+            fail("images are given as name=path, not %s" % image)
+        images.append((name, pack(path, args.band)))
+
+    write_source(args.output, images)
+
+
+if __name__ == "__main__":
+    main()
+
+# End of pack_images.py